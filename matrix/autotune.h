@@ -0,0 +1,310 @@
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "matrix.h"
+#include "reduced_precision.h"
+
+struct CacheSizes {
+  size_t l1 = 0;
+  size_t l2 = 0;
+  size_t l3 = 0;
+};
+
+inline bool operator==(const CacheSizes& a, const CacheSizes& b) {
+  return a.l1 == b.l1 && a.l2 == b.l2 && a.l3 == b.l3;
+}
+
+inline bool operator!=(const CacheSizes& a, const CacheSizes& b) {
+  return !(a == b);
+}
+
+inline void StoreCacheSize(CacheSizes& caches, size_t level, size_t size) {
+  if (level == 1) {
+    caches.l1 = size;
+  } else if (level == 2) {
+    caches.l2 = size;
+  } else if (level == 3) {
+    caches.l3 = size;
+  }
+}
+
+inline CacheSizes ReadSysfsCacheSizes() {
+  CacheSizes caches;
+  for (size_t index = 0;; index++) {
+    std::string directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+    std::ifstream level_file(directory + "level");
+    std::ifstream type_file(directory + "type");
+    std::ifstream size_file(directory + "size");
+    if (!level_file || !type_file || !size_file) {
+      break;
+    }
+    size_t level = 0, size = 0;
+    std::string type;
+    char unit = 0;
+    level_file >> level;
+    type_file >> type;
+    size_file >> size >> unit;
+    if (type == "Instruction") {
+      continue;
+    }
+    if (unit == 'K') {
+      size <<= 10;
+    } else if (unit == 'M') {
+      size <<= 20;
+    } else if (unit == 'G') {
+      size <<= 30;
+    }
+    StoreCacheSize(caches, level, size);
+  }
+  return caches;
+}
+
+inline CacheSizes ReadCpuidCacheSizes() {
+  CacheSizes caches;
+#if defined(__x86_64__) || defined(__i386__)
+  // Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD, both in the same format.
+  for (unsigned leaf : {4u, 0x8000001Du}) {
+    for (unsigned subleaf = 0;; subleaf++) {
+      unsigned eax, ebx, ecx, edx;
+      if (!__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx) || (eax & 0x1F) == 0) {
+        break;
+      }
+      if ((eax & 0x1F) == 2) {
+        continue;
+      }
+      size_t ways = ((ebx >> 22) & 0x3FF) + 1;
+      size_t partitions = ((ebx >> 12) & 0x3FF) + 1;
+      size_t line = (ebx & 0xFFF) + 1;
+      size_t sets = static_cast<size_t>(ecx) + 1;
+      StoreCacheSize(caches, (eax >> 5) & 0x7, ways * partitions * line * sets);
+    }
+    if (caches.l1 != 0) {
+      break;
+    }
+  }
+#endif
+  return caches;
+}
+
+// Data cache sizes of the current CPU in bytes, from sysfs, then CPUID, then conservative defaults.
+inline CacheSizes DetectCacheSizes() {
+  CacheSizes caches = ReadSysfsCacheSizes();
+  if (caches.l1 == 0 || caches.l2 == 0) {
+    caches = ReadCpuidCacheSizes();
+  }
+  if (caches.l1 == 0) {
+    caches.l1 = 32 << 10;
+  }
+  if (caches.l2 == 0) {
+    caches.l2 = 256 << 10;
+  }
+  if (caches.l3 == 0) {
+    caches.l3 = caches.l2;
+  }
+  return caches;
+}
+
+inline size_t ClampTileSize(size_t size, size_t multiple) {
+  return std::clamp(size / multiple * multiple, multiple, size_t{4096});
+}
+
+// Type in which the blocked kernel for T holds its tiles: T itself, or the accumulator that MultiplyAddWidenedBlocked
+// widens storage-only types such as Half to.
+template <class T>
+using MatrixKernelType = std::conditional_t<std::is_arithmetic_v<T>, T, typename MatrixAccumulator<T>::Type>;
+
+// A row of c and a row of b share half of L1, a depth x columns block of b fills half of L2, and a rows x columns
+// block of c fills a quarter of L3.
+template <class T>
+MatrixTileSizes GetHeuristicTileSizes(const CacheSizes& caches) {
+  constexpr size_t kSize = sizeof(MatrixKernelType<T>);
+  MatrixTileSizes tiles;
+  tiles.columns = ClampTileSize(caches.l1 / (4 * kSize), 16);
+  tiles.depth = ClampTileSize(caches.l2 / (2 * tiles.columns * kSize), 8);
+  tiles.rows = std::min(ClampTileSize(caches.l3 / (4 * tiles.columns * kSize), 8), size_t{256});
+  return tiles;
+}
+
+// Times the heuristic tiles and their neighbours on a size x size x size product with the kernel that multiplies T
+// matrices and returns the fastest.
+template <class T>
+MatrixTileSizes MeasureTileSizes(const CacheSizes& caches, size_t size = 256) {
+  auto a = std::make_unique<T[]>(size * size);
+  auto b = std::make_unique<T[]>(size * size);
+  auto c = std::make_unique<T[]>(size * size);
+  std::fill_n(a.get(), size * size, T(1));
+  std::fill_n(b.get(), size * size, T(1));
+  const MatrixTileSizes saved = GetMatrixTileSizes<T>();
+  const MatrixTileSizes base = GetHeuristicTileSizes<T>(caches);
+  MatrixTileSizes best = base;
+  auto best_time = std::chrono::steady_clock::duration::max();
+  for (size_t rows : {base.rows / 2, base.rows, base.rows * 2}) {
+    for (size_t depth : {base.depth / 2, base.depth, base.depth * 2}) {
+      for (size_t columns : {base.columns / 2, base.columns, base.columns * 2}) {
+        MatrixTileSizes candidate{std::max<size_t>(rows, 1), std::max<size_t>(depth, 1), std::max<size_t>(columns, 1)};
+        GetMatrixTileSizes<T>() = candidate;
+        auto time = std::chrono::steady_clock::duration::max();
+        for (size_t repeat = 0; repeat < 2; repeat++) {
+          auto start = std::chrono::steady_clock::now();
+          if constexpr (std::is_arithmetic_v<T>) {
+            MultiplyAddBlocked(size, size, size, a.get(), size, b.get(), size, c.get(), size);
+          } else {
+            const MatrixStrides strides{size, 1};
+            MultiplyAddWidenedBlocked<MatrixKernelType<T>>(size, size, size, a.get(), strides, b.get(), strides, c.get(), strides);
+          }
+          time = std::min(time, std::chrono::steady_clock::now() - start);
+        }
+        if (time < best_time) {
+          best_time = time;
+          best = candidate;
+        }
+      }
+    }
+  }
+  GetMatrixTileSizes<T>() = saved;
+  return best;
+}
+
+// $MATRIX_TILES_CACHE, or matrix_tiles in $XDG_CACHE_HOME or ~/.cache; empty if none of them is set.
+inline std::string GetMatrixTilesCachePath() {
+  if (const char* path = std::getenv("MATRIX_TILES_CACHE")) {
+    return path;
+  }
+  if (const char* directory = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(directory) + "/matrix_tiles";
+  }
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/matrix_tiles";
+  }
+  return {};
+}
+
+// Tiles for one element type; measured tells timed tiles from heuristic ones.
+struct MatrixTilesEntry {
+  std::string kind;
+  size_t element_size = 0;
+  bool measured = false;
+  MatrixTileSizes tiles{};
+};
+
+// The cache file starts with "matrix-tiles <version>" followed by lines
+// "l1 l2 l3 kind element_size measured rows depth columns", so a file copied to a machine with different caches is
+// ignored rather than trusted.
+constexpr int kMatrixTilesCacheVersion = 2;
+
+inline bool ReadMatrixTilesHeader(std::istream& in) {
+  std::string magic;
+  int version = 0;
+  return in >> magic >> version && magic == "matrix-tiles" && version == kMatrixTilesCacheVersion;
+}
+
+inline bool ReadMatrixTilesEntry(std::istream& in, CacheSizes& caches, MatrixTilesEntry& entry) {
+  return static_cast<bool>(in >> caches.l1 >> caches.l2 >> caches.l3 >> entry.kind >> entry.element_size >> entry.measured >>
+                           entry.tiles.rows >> entry.tiles.depth >> entry.tiles.columns);
+}
+
+inline void WriteMatrixTilesEntry(std::ostream& out, const CacheSizes& caches, const MatrixTilesEntry& entry) {
+  out << caches.l1 << ' ' << caches.l2 << ' ' << caches.l3 << ' ' << entry.kind << ' ' << entry.element_size << ' '
+      << (entry.measured ? 1 : 0) << ' ' << entry.tiles.rows << ' ' << entry.tiles.depth << ' ' << entry.tiles.columns
+      << '\n';
+}
+
+// Looks up the entry for caches and entry.kind and entry.element_size, filling in its measured flag and tiles.
+inline bool LoadMatrixTileSizes(const std::string& path, const CacheSizes& caches, MatrixTilesEntry& entry) {
+  std::ifstream in(path);
+  if (!ReadMatrixTilesHeader(in)) {
+    return false;
+  }
+  CacheSizes entry_caches;
+  MatrixTilesEntry stored;
+  while (ReadMatrixTilesEntry(in, entry_caches, stored)) {
+    if (entry_caches == caches && stored.kind == entry.kind && stored.element_size == entry.element_size &&
+        stored.tiles.rows > 0 && stored.tiles.depth > 0 && stored.tiles.columns > 0) {
+      entry = stored;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds entry to the cache file, replacing the one for the same caches, kind and element size.
+inline bool SaveMatrixTileSizes(const std::string& path, const CacheSizes& caches, const MatrixTilesEntry& entry) {
+  std::ostringstream out;
+  out << "matrix-tiles " << kMatrixTilesCacheVersion << '\n';
+  WriteMatrixTilesEntry(out, caches, entry);
+  std::ifstream in(path);
+  if (ReadMatrixTilesHeader(in)) {
+    CacheSizes entry_caches;
+    MatrixTilesEntry stored;
+    while (ReadMatrixTilesEntry(in, entry_caches, stored)) {
+      if (entry_caches != caches || stored.kind != entry.kind || stored.element_size != entry.element_size) {
+        WriteMatrixTilesEntry(out, entry_caches, stored);
+      }
+    }
+  }
+  in.close();
+  // A unique temporary next to the file, so that processes saving at the same time do not write into each other's.
+  std::string temporary = path + ".XXXXXX";
+  const int descriptor = mkstemp(temporary.data());
+  if (descriptor == -1) {
+    return false;
+  }
+  const std::string contents = out.str();
+  size_t written = 0;
+  while (written < contents.size()) {
+    const ssize_t result = write(descriptor, contents.data() + written, contents.size() - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    written += static_cast<size_t>(result);
+  }
+  if (close(descriptor) != 0 || written != contents.size() || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Picks tile sizes for T: from the cache file if it has an entry for this CPU and element type, otherwise from the
+// cache-size heuristic (refined by timing if measure is set), which is then saved for later runs. A heuristic entry
+// does not satisfy a call with measure set; it is measured and replaced. Failing to read or write the cache file is not
+// an error.
+template <class T>
+MatrixTileSizes AutotuneMatrixKernel(bool measure = false, const std::string& path = GetMatrixTilesCachePath()) {
+  const CacheSizes caches = DetectCacheSizes();
+  MatrixTilesEntry entry;
+  entry.kind = MatrixElementKind<T>::kName;
+  entry.element_size = sizeof(T);
+  const bool cached = !path.empty() && LoadMatrixTileSizes(path, caches, entry);
+  if (!cached || (measure && !entry.measured)) {
+    entry.measured = measure;
+    entry.tiles = measure ? MeasureTileSizes<T>(caches) : GetHeuristicTileSizes<T>(caches);
+    if (!path.empty()) {
+      SaveMatrixTileSizes(path, caches, entry);
+    }
+  }
+  SetMatrixTileSizes<T>(entry.tiles);
+  return entry.tiles;
+}
+
+#endif
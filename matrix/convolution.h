@@ -0,0 +1,195 @@
+#ifndef CONVOLUTION_H_
+#define CONVOLUTION_H_
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "matrix.h"
+
+enum class ConvolutionAlgorithm {
+  kAuto,
+  kDirect,
+  kIm2col,
+  kFft,
+};
+
+template <size_t H, size_t W, size_t KH, size_t KW, size_t Stride, size_t Padding>
+struct ConvolutionShape {
+  static_assert(Stride > 0, "stride must be positive");
+  static_assert(H + 2 * Padding >= KH && W + 2 * Padding >= KW, "kernel does not fit into the padded input");
+
+  static constexpr size_t kRows = (H + 2 * Padding - KH) / Stride + 1;
+  static constexpr size_t kColumns = (W + 2 * Padding - KW) / Stride + 1;
+
+  // Range of output indices o for which o * Stride + tap - Padding lies inside [0, size).
+  static void GetValidRange(size_t size, size_t tap, size_t outputs, size_t& begin, size_t& end) {
+    auto first = static_cast<ptrdiff_t>(Padding) - static_cast<ptrdiff_t>(tap);
+    auto last = static_cast<ptrdiff_t>(size) - 1 + first;
+    begin = first <= 0 ? 0 : (first + Stride - 1) / Stride;
+    end = last < 0 ? 0 : std::min(outputs, static_cast<size_t>(last) / Stride + 1);
+    if (begin > end) {
+      begin = end;
+    }
+  }
+};
+
+template <class T, size_t H, size_t W, size_t KH, size_t KW, size_t Stride, size_t Padding>
+using ConvolutionResult = Matrix<T, ConvolutionShape<H, W, KH, KW, Stride, Padding>::kRows, ConvolutionShape<H, W, KH, KW, Stride, Padding>::kColumns>;
+
+// Kernels with at most this many taps are applied directly, larger ones are lowered to im2col and a matrix product.
+constexpr size_t kDirectConvolutionMaxTaps = 25;
+
+// Accumulates one kernel tap at a time over whole output rows, so the innermost loop is a contiguous
+// multiply-add that the compiler vectorizes when the stride is 1.
+template <size_t Stride, size_t Padding, class T, size_t H, size_t W, size_t KH, size_t KW>
+void ConvolveDirect(const Matrix<T, H, W>& input, const Matrix<T, KH, KW>& kernel, ConvolutionResult<T, H, W, KH, KW, Stride, Padding>& result) {
+  using Shape = ConvolutionShape<H, W, KH, KW, Stride, Padding>;
+  for (size_t u = 0; u < KH; u++) {
+    size_t row_begin, row_end;
+    Shape::GetValidRange(H, u, Shape::kRows, row_begin, row_end);
+    for (size_t v = 0; v < KW; v++) {
+      size_t column_begin, column_end;
+      Shape::GetValidRange(W, v, Shape::kColumns, column_begin, column_end);
+      const T& weight = kernel(u, v);
+      for (size_t oy = row_begin; oy < row_end; oy++) {
+        const T* in = &input.matrix[oy * Stride + u - Padding][0];
+        T* out = &result.matrix[oy][0];
+        for (size_t ox = column_begin; ox < column_end; ox++) {
+          out[ox] += weight * in[ox * Stride + v - Padding];
+        }
+      }
+    }
+  }
+}
+
+// Unfolds the padded input into a (KH * KW) x (rows * columns) matrix and multiplies the flattened kernel by it.
+template <size_t Stride, size_t Padding, class T, size_t H, size_t W, size_t KH, size_t KW>
+void ConvolveIm2col(const Matrix<T, H, W>& input, const Matrix<T, KH, KW>& kernel, ConvolutionResult<T, H, W, KH, KW, Stride, Padding>& result) {
+  using Shape = ConvolutionShape<H, W, KH, KW, Stride, Padding>;
+  constexpr size_t kOutputs = Shape::kRows * Shape::kColumns;
+  auto columns = std::make_unique<T[]>(KH * KW * kOutputs);
+  for (size_t u = 0; u < KH; u++) {
+    size_t row_begin, row_end;
+    Shape::GetValidRange(H, u, Shape::kRows, row_begin, row_end);
+    for (size_t v = 0; v < KW; v++) {
+      size_t column_begin, column_end;
+      Shape::GetValidRange(W, v, Shape::kColumns, column_begin, column_end);
+      T* row = columns.get() + (u * KW + v) * kOutputs;
+      for (size_t oy = row_begin; oy < row_end; oy++) {
+        for (size_t ox = column_begin; ox < column_end; ox++) {
+          row[oy * Shape::kColumns + ox] = input(oy * Stride + u - Padding, ox * Stride + v - Padding);
+        }
+      }
+    }
+  }
+  MultiplyAddBlocked(1, KH * KW, kOutputs, &kernel.matrix[0][0], KH * KW, columns.get(), kOutputs, &result.matrix[0][0], kOutputs);
+}
+
+inline void TransformFft(std::complex<double>* data, size_t size, size_t step, bool inverse) {
+  for (size_t i = 1, j = 0; i < size; i++) {
+    size_t bit = size >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(data[i * step], data[j * step]);
+    }
+  }
+  const double pi = std::acos(-1.0);
+  for (size_t length = 2; length <= size; length <<= 1) {
+    double angle = 2 * pi / static_cast<double>(length) * (inverse ? 1 : -1);
+    std::complex<double> root(std::cos(angle), std::sin(angle));
+    for (size_t i = 0; i < size; i += length) {
+      std::complex<double> w(1);
+      for (size_t j = 0; j < length / 2; j++) {
+        auto even = data[(i + j) * step];
+        auto odd = data[(i + j + length / 2) * step] * w;
+        data[(i + j) * step] = even + odd;
+        data[(i + j + length / 2) * step] = even - odd;
+        w *= root;
+      }
+    }
+  }
+  if (inverse) {
+    for (size_t i = 0; i < size; i++) {
+      data[i * step] /= static_cast<double>(size);
+    }
+  }
+}
+
+inline void TransformFft2d(std::complex<double>* data, size_t rows, size_t columns, bool inverse) {
+  for (size_t i = 0; i < rows; i++) {
+    TransformFft(data + i * columns, columns, 1, inverse);
+  }
+  for (size_t j = 0; j < columns; j++) {
+    TransformFft(data + j, rows, columns, inverse);
+  }
+}
+
+// Correlation theorem: the padded input and the kernel are transformed on a power-of-two grid large enough to avoid
+// wrap-around, multiplied pointwise (with the kernel spectrum conjugated) and transformed back.
+template <size_t Stride, size_t Padding, class T, size_t H, size_t W, size_t KH, size_t KW>
+void ConvolveFft(const Matrix<T, H, W>& input, const Matrix<T, KH, KW>& kernel, ConvolutionResult<T, H, W, KH, KW, Stride, Padding>& result) {
+  static_assert(std::is_floating_point_v<T>, "the FFT path is only available for floating point matrices");
+  using Shape = ConvolutionShape<H, W, KH, KW, Stride, Padding>;
+  size_t rows = 1, columns = 1;
+  while (rows < H + 2 * Padding) {
+    rows <<= 1;
+  }
+  while (columns < W + 2 * Padding) {
+    columns <<= 1;
+  }
+  auto signal = std::make_unique<std::complex<double>[]>(rows * columns);
+  auto filter = std::make_unique<std::complex<double>[]>(rows * columns);
+  for (size_t i = 0; i < H; i++) {
+    for (size_t j = 0; j < W; j++) {
+      signal[(i + Padding) * columns + j + Padding] = input(i, j);
+    }
+  }
+  for (size_t u = 0; u < KH; u++) {
+    for (size_t v = 0; v < KW; v++) {
+      filter[u * columns + v] = kernel(u, v);
+    }
+  }
+  TransformFft2d(signal.get(), rows, columns, false);
+  TransformFft2d(filter.get(), rows, columns, false);
+  for (size_t i = 0; i < rows * columns; i++) {
+    signal[i] *= std::conj(filter[i]);
+  }
+  TransformFft2d(signal.get(), rows, columns, true);
+  for (size_t oy = 0; oy < Shape::kRows; oy++) {
+    for (size_t ox = 0; ox < Shape::kColumns; ox++) {
+      result(oy, ox) += static_cast<T>(signal[oy * Stride * columns + ox * Stride].real());
+    }
+  }
+}
+
+// Cross-correlates input with kernel (the usual "convolution" of image processing), treating the input as
+// surrounded by Padding zeros and moving the kernel by Stride in both directions.
+template <size_t Stride = 1, size_t Padding = 0, class T, size_t H, size_t W, size_t KH, size_t KW>
+ConvolutionResult<T, H, W, KH, KW, Stride, Padding> Convolve(const Matrix<T, H, W>& input, const Matrix<T, KH, KW>& kernel, ConvolutionAlgorithm algorithm = ConvolutionAlgorithm::kAuto) {
+  ConvolutionResult<T, H, W, KH, KW, Stride, Padding> result{};
+  if (algorithm == ConvolutionAlgorithm::kAuto) {
+    algorithm = KH * KW <= kDirectConvolutionMaxTaps ? ConvolutionAlgorithm::kDirect : ConvolutionAlgorithm::kIm2col;
+  }
+  if (algorithm == ConvolutionAlgorithm::kDirect) {
+    ConvolveDirect<Stride, Padding>(input, kernel, result);
+  } else if (algorithm == ConvolutionAlgorithm::kIm2col) {
+    ConvolveIm2col<Stride, Padding>(input, kernel, result);
+  } else {
+    if constexpr (std::is_floating_point_v<T>) {
+      ConvolveFft<Stride, Padding>(input, kernel, result);
+    } else {
+      throw std::invalid_argument("ConvolutionAlgorithm::kFft requires a floating point matrix");
+    }
+  }
+  return result;
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef INCREMENTAL_INVERSE_H_
+#define INCREMENTAL_INVERSE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "matrix.h"
+
+// Keeps a square matrix together with its inverse and determinant. Low-rank changes A += U * V are applied with the
+// Sherman-Morrison-Woodbury formula in O(N^2 K) instead of inverting from scratch:
+//   (A + U V)^-1 = A^-1 - A^-1 U (I + V A^-1 U)^-1 V A^-1,  det(A + U V) = det(A) det(I + V A^-1 U).
+// The inverse is refactorized from the stored matrix when the K x K capacitance matrix I + V A^-1 U is
+// ill-conditioned or nearly cancels, or when the residual |A A^-1 p - p| on a fixed probe vector p exceeds the
+// tolerance.
+template <class T, size_t N>
+class IncrementalInverse {
+  static_assert(std::is_floating_point_v<T>, "IncrementalInverse requires a floating point matrix");
+
+ public:
+  explicit IncrementalInverse(const Matrix<T, N, N>& matrix, T tolerance = std::sqrt(std::numeric_limits<T>::epsilon()))
+      : tolerance_{tolerance} {
+    Factorize(std::make_unique<Matrix<T, N, N>>(matrix));
+  }
+
+  const Matrix<T, N, N>& GetMatrix() const {
+    return *matrix_;
+  }
+
+  const Matrix<T, N, N>& GetInversed() const {
+    return *inverse_;
+  }
+
+  T GetDeterminant() const {
+    return determinant_;
+  }
+
+  size_t UpdatesSinceRefactorization() const {
+    return updates_;
+  }
+
+  // A += U * V. Throws MatrixIsDegenerateError and leaves the object unchanged if the updated matrix is singular.
+  template <size_t K>
+  void Update(const Matrix<T, N, K>& u, const Matrix<T, K, N>& v) {
+    Apply(K, &u.matrix[0][0], &v.matrix[0][0]);
+  }
+
+  // A += u * v^T.
+  void UpdateRank1(const Matrix<T, N, 1>& u, const Matrix<T, 1, N>& v) {
+    Apply(1, &u.matrix[0][0], &v.matrix[0][0]);
+  }
+
+  void SetRow(size_t row, const Matrix<T, 1, N>& values) {
+    if (row >= N) {
+      throw MatrixOutOfRange{};
+    }
+    auto u = std::make_unique<T[]>(N);
+    auto v = std::make_unique<T[]>(N);
+    u[row] = 1;
+    for (size_t j = 0; j < N; j++) {
+      v[j] = values(0, j) - (*matrix_)(row, j);
+    }
+    Apply(1, u.get(), v.get());
+  }
+
+  void SetColumn(size_t column, const Matrix<T, N, 1>& values) {
+    if (column >= N) {
+      throw MatrixOutOfRange{};
+    }
+    auto u = std::make_unique<T[]>(N);
+    auto v = std::make_unique<T[]>(N);
+    for (size_t i = 0; i < N; i++) {
+      u[i] = values(i, 0) - (*matrix_)(i, column);
+    }
+    v[column] = 1;
+    Apply(1, u.get(), v.get());
+  }
+
+  void Refactorize() {
+    Factorize(std::make_unique<Matrix<T, N, N>>(*matrix_));
+  }
+
+  // max |A A^-1 p - p| for p = (1, -1, 1, ...): zero in exact arithmetic, grows with the accumulated rounding error.
+  T GetResidual() const {
+    return GetResidual(*matrix_, *inverse_);
+  }
+
+ private:
+  std::unique_ptr<Matrix<T, N, N>> matrix_;
+  std::unique_ptr<Matrix<T, N, N>> inverse_;
+  T determinant_ = 0;
+  T tolerance_;
+  size_t updates_ = 0;
+
+  static T GetResidual(const Matrix<T, N, N>& matrix, const Matrix<T, N, N>& inverse) {
+    auto probe = std::make_unique<T[]>(N);
+    auto solution = std::make_unique<T[]>(N);
+    auto check = std::make_unique<T[]>(N);
+    for (size_t i = 0; i < N; i++) {
+      probe[i] = i % 2 == 0 ? 1 : -1;
+    }
+    MultiplyAddBlocked(N, N, 1, &inverse.matrix[0][0], N, probe.get(), 1, solution.get(), 1);
+    MultiplyAddBlocked(N, N, 1, &matrix.matrix[0][0], N, solution.get(), 1, check.get(), 1);
+    T residual = 0;
+    for (size_t i = 0; i < N; i++) {
+      residual = std::max(residual, std::abs(check[i] - probe[i]));
+    }
+    return residual;
+  }
+
+  // Gauss-Jordan elimination with partial pivoting of the n x n matrix a (destroyed) into inverse. Returns the
+  // determinant, or zero if a is singular.
+  static T Invert(T* a, T* inverse, size_t n) {
+    std::fill_n(inverse, n * n, T(0));
+    for (size_t i = 0; i < n; i++) {
+      inverse[i * n + i] = 1;
+    }
+    T determinant = 1;
+    for (size_t k = 0; k < n; k++) {
+      size_t pivot = k;
+      for (size_t i = k + 1; i < n; i++) {
+        if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k])) {
+          pivot = i;
+        }
+      }
+      if (a[pivot * n + k] == 0) {
+        return 0;
+      }
+      if (pivot != k) {
+        std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+        std::swap_ranges(inverse + k * n, inverse + (k + 1) * n, inverse + pivot * n);
+        determinant = -determinant;
+      }
+      const T value = a[k * n + k];
+      determinant *= value;
+      for (size_t j = 0; j < n; j++) {
+        a[k * n + j] /= value;
+        inverse[k * n + j] /= value;
+      }
+      for (size_t i = 0; i < n; i++) {
+        const T factor = a[i * n + k];
+        if (i == k || factor == 0) {
+          continue;
+        }
+        for (size_t j = 0; j < n; j++) {
+          a[i * n + j] -= factor * a[k * n + j];
+          inverse[i * n + j] -= factor * inverse[k * n + j];
+        }
+      }
+    }
+    return determinant;
+  }
+
+  static T GetNorm(const T* a, size_t n) {
+    T norm = 0;
+    for (size_t i = 0; i < n; i++) {
+      T sum = 0;
+      for (size_t j = 0; j < n; j++) {
+        sum += std::abs(a[i * n + j]);
+      }
+      norm = std::max(norm, sum);
+    }
+    return norm;
+  }
+
+  void Factorize(std::unique_ptr<Matrix<T, N, N>> matrix) {
+    auto work = std::make_unique<Matrix<T, N, N>>(*matrix);
+    auto inverse = std::make_unique<Matrix<T, N, N>>();
+    const T determinant = Invert(&work->matrix[0][0], &inverse->matrix[0][0], N);
+    if (determinant == 0) {
+      throw MatrixIsDegenerateError{};
+    }
+    matrix_ = std::move(matrix);
+    inverse_ = std::move(inverse);
+    determinant_ = determinant;
+    updates_ = 0;
+  }
+
+  // u is n x k, v is k x n, both row-major.
+  void Apply(size_t k, const T* u, const T* v) {
+    auto updated = std::make_unique<Matrix<T, N, N>>(*matrix_);
+    MultiplyAddBlocked(N, k, N, u, k, v, N, &updated->matrix[0][0], N);
+    auto x = std::make_unique<T[]>(N * k);
+    auto y = std::make_unique<T[]>(k * N);
+    MultiplyAddBlocked(N, N, k, &inverse_->matrix[0][0], N, u, k, x.get(), k);
+    MultiplyAddBlocked(k, N, N, v, N, &inverse_->matrix[0][0], N, y.get(), N);
+    auto capacitance = std::make_unique<T[]>(k * k);
+    for (size_t i = 0; i < k; i++) {
+      capacitance[i * k + i] = 1;
+    }
+    MultiplyAddBlocked(k, N, k, v, N, x.get(), k, capacitance.get(), k);
+    // I + |V| |A^-1 U| bounds the terms summed into the capacitance matrix, so comparing it with the inverse also
+    // catches cancellation, e.g. 1 + v^T A^-1 u close to zero in a rank-1 update.
+    auto magnitude = std::make_unique<T[]>(k * k);
+    auto v_magnitude = std::make_unique<T[]>(k * N);
+    auto x_magnitude = std::make_unique<T[]>(N * k);
+    std::transform(v, v + k * N, v_magnitude.get(), [](T value) { return std::abs(value); });
+    std::transform(x.get(), x.get() + N * k, x_magnitude.get(), [](T value) { return std::abs(value); });
+    for (size_t i = 0; i < k; i++) {
+      magnitude[i * k + i] = 1;
+    }
+    MultiplyAddBlocked(k, N, k, v_magnitude.get(), N, x_magnitude.get(), k, magnitude.get(), k);
+    auto capacitance_inverse = std::make_unique<T[]>(k * k);
+    const T capacitance_determinant = Invert(capacitance.get(), capacitance_inverse.get(), k);
+    if (capacitance_determinant == 0 || GetNorm(magnitude.get(), k) * GetNorm(capacitance_inverse.get(), k) * tolerance_ > 1) {
+      Factorize(std::move(updated));
+      return;
+    }
+    // A^-1 -= (A^-1 U C^-1) (V A^-1)
+    auto correction = std::make_unique<T[]>(N * k);
+    MultiplyAddBlocked(N, k, k, x.get(), k, capacitance_inverse.get(), k, correction.get(), k);
+    for (size_t i = 0; i < N * k; i++) {
+      correction[i] = -correction[i];
+    }
+    auto inverse = std::make_unique<Matrix<T, N, N>>(*inverse_);
+    MultiplyAddBlocked(N, k, N, correction.get(), k, y.get(), N, &inverse->matrix[0][0], N);
+    if (GetResidual(*updated, *inverse) > tolerance_) {
+      Factorize(std::move(updated));
+      return;
+    }
+    matrix_ = std::move(updated);
+    inverse_ = std::move(inverse);
+    determinant_ *= capacitance_determinant;
+    updates_++;
+  }
+};
+
+#endif
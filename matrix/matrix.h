@@ -1,8 +1,12 @@
 #ifndef MATRIX_H_
 #define MATRIX_H_
 
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 class MatrixIsDegenerateError : public std::runtime_error {
  public:
@@ -16,10 +20,30 @@ class MatrixOutOfRange : public std::out_of_range {
   }
 };
 
-template <class T, size_t N, size_t M>
+enum class MatrixLayout {
+  kRowMajor,
+  kColumnMajor,
+};
+
+constexpr MatrixLayout GetTransposedLayout(MatrixLayout layout) {
+  return layout == MatrixLayout::kRowMajor ? MatrixLayout::kColumnMajor : MatrixLayout::kRowMajor;
+}
+
+template <class T>
+struct MatrixMultiplier;
+
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+class MatrixView;
+
+// A row-major matrix stores matrix[i][j], a column-major one stores matrix[j][i]; aggregate initialization follows the
+// storage order.
+template <class T, size_t N, size_t M, MatrixLayout Layout = MatrixLayout::kRowMajor>
 class Matrix {
  public:
-  T matrix[N][M];
+  static constexpr size_t kStorageRows = Layout == MatrixLayout::kRowMajor ? N : M;
+  static constexpr size_t kStorageColumns = Layout == MatrixLayout::kRowMajor ? M : N;
+
+  T matrix[kStorageRows][kStorageColumns];
 
   size_t RowsNumber() const {
     return N;
@@ -30,120 +54,391 @@ class Matrix {
   }
 
   T& operator()(size_t i, size_t j) {
-    return matrix[i][j];
+    if constexpr (Layout == MatrixLayout::kRowMajor) {
+      return matrix[i][j];
+    } else {
+      return matrix[j][i];
+    }
   }
 
   const T& operator()(size_t i, size_t j) const {
-    return matrix[i][j];
+    if constexpr (Layout == MatrixLayout::kRowMajor) {
+      return matrix[i][j];
+    } else {
+      return matrix[j][i];
+    }
   }
 
   T& At(size_t i, size_t j) {
     if (i >= N || j >= M) {
       throw MatrixOutOfRange{};
     }
-    return matrix[i][j];
+    return operator()(i, j);
   }
 
   const T& At(size_t i, size_t j) const {
     if (i >= N || j >= M) {
       throw MatrixOutOfRange{};
     }
-    return matrix[i][j];
+    return operator()(i, j);
   }
 
-  Matrix<T, N, M>& operator+=(const Matrix<T, N, M>& other) {
-    for (size_t i = 0; i < N; i++) {
-      for (size_t j = 0; j < M; j++) {
+  Matrix<T, N, M, Layout>& operator+=(const Matrix<T, N, M, Layout>& other) {
+    for (size_t i = 0; i < kStorageRows; i++) {
+      for (size_t j = 0; j < kStorageColumns; j++) {
         matrix[i][j] += other.matrix[i][j];
       }
     }
     return *this;
   }
 
-  Matrix<T, N, M> operator+(const Matrix<T, N, M>& other) const {
+  Matrix<T, N, M, Layout> operator+(const Matrix<T, N, M, Layout>& other) const {
     auto result = *this;
     return result += other;
   }
 
-  Matrix<T, N, M>& operator-=(const Matrix<T, N, M>& other) {
-    for (size_t i = 0; i < N; i++) {
-      for (size_t j = 0; j < M; j++) {
+  Matrix<T, N, M, Layout>& operator-=(const Matrix<T, N, M, Layout>& other) {
+    for (size_t i = 0; i < kStorageRows; i++) {
+      for (size_t j = 0; j < kStorageColumns; j++) {
         matrix[i][j] -= other.matrix[i][j];
       }
     }
     return *this;
   }
 
-  Matrix<T, N, M> operator-(const Matrix<T, N, M>& other) const {
+  Matrix<T, N, M, Layout> operator-(const Matrix<T, N, M, Layout>& other) const {
     auto result = *this;
     return result -= other;
   }
 
-  template <size_t L>
-  Matrix<T, N, L> operator*(const Matrix<T, M, L>& other) const {
-    Matrix<T, N, L> result{};
-    for (size_t i = 0; i < N; i++) {
-      for (size_t j = 0; j < L; j++) {
-        for (size_t k = 0; k < M; k++) {
-          result.matrix[i][j] += matrix[i][k] * other.matrix[k][j];
-        }
-      }
-    }
+  template <size_t L, MatrixLayout OtherLayout>
+  Matrix<T, N, L, Layout> operator*(const Matrix<T, M, L, OtherLayout>& other) const {
+    return *this * MatrixView<T, M, L, OtherLayout>(other);
+  }
+
+  template <size_t L, MatrixLayout OtherLayout>
+  Matrix<T, N, L, Layout> operator*(MatrixView<T, M, L, OtherLayout> other) const {
+    Matrix<T, N, L, Layout> result{};
+    MatrixMultiplier<T>::Multiply(MatrixView<T, N, M, Layout>(*this), other, result);
     return std::move(result);
   }
 
-  template <size_t L>
-  Matrix<T, N, L>& operator*=(const Matrix<T, M, L>& other) {
+  template <size_t L, MatrixLayout OtherLayout>
+  Matrix<T, N, L, Layout>& operator*=(const Matrix<T, M, L, OtherLayout>& other) {
     return *this = *this * other;
   }
 
-  Matrix<T, N, M>& operator*=(const T& k) {
-    for (size_t i = 0; i < N; i++) {
-      for (size_t j = 0; j < M; j++) {
+  Matrix<T, N, M, Layout>& operator*=(const T& k) {
+    for (size_t i = 0; i < kStorageRows; i++) {
+      for (size_t j = 0; j < kStorageColumns; j++) {
         matrix[i][j] *= k;
       }
     }
     return *this;
   }
 
-  Matrix<T, N, M> operator*(const T& k) const {
+  Matrix<T, N, M, Layout> operator*(const T& k) const {
     auto result = *this;
     return result *= k;
   }
 
-  Matrix<T, N, M>& operator/=(const T& k) {
-    for (size_t i = 0; i < N; i++) {
-      for (size_t j = 0; j < M; j++) {
+  Matrix<T, N, M, Layout>& operator/=(const T& k) {
+    for (size_t i = 0; i < kStorageRows; i++) {
+      for (size_t j = 0; j < kStorageColumns; j++) {
         matrix[i][j] /= k;
       }
     }
     return *this;
   }
 
-  Matrix<T, N, M> operator/(const T& k) const {
+  Matrix<T, N, M, Layout> operator/(const T& k) const {
     auto result = *this;
     return result /= k;
   }
 };
 
-template <class T, size_t N, size_t M>
-Matrix<T, M, N> GetTransposed(const Matrix<T, N, M>& matrix) {
-  Matrix<T, M, N> result;
-  for (size_t i = 0; i < N; i++) {
-    for (size_t j = 0; j < M; j++) {
-      result(j, i) = matrix(i, j);
+// Read-only N x M matrix over elements stored elsewhere in the given layout, which it does not own. The storage of an
+// N x M matrix is also the storage of its M x N transpose in the opposite layout, so GetTransposedView turns a matrix
+// into its transpose without copying, and products accept views wherever they accept matrices.
+template <class T, size_t N, size_t M, MatrixLayout Layout = MatrixLayout::kRowMajor>
+class MatrixView {
+ public:
+  explicit MatrixView(const T* data) : data_{data} {
+  }
+
+  MatrixView(const Matrix<T, N, M, Layout>& matrix) : data_{&matrix.matrix[0][0]} {  // NOLINT
+  }
+
+  MatrixView(const Matrix<T, N, M, Layout>&&) = delete;
+
+  size_t RowsNumber() const {
+    return N;
+  }
+
+  size_t ColumnsNumber() const {
+    return M;
+  }
+
+  const T& operator()(size_t i, size_t j) const {
+    if constexpr (Layout == MatrixLayout::kRowMajor) {
+      return data_[i * M + j];
+    } else {
+      return data_[j * N + i];
     }
   }
-  return std::move(result);
+
+  const T& At(size_t i, size_t j) const {
+    if (i >= N || j >= M) {
+      throw MatrixOutOfRange{};
+    }
+    return operator()(i, j);
+  }
+
+  const T* Data() const {
+    return data_;
+  }
+
+  template <size_t L, MatrixLayout OtherLayout>
+  Matrix<T, N, L, Layout> operator*(MatrixView<T, M, L, OtherLayout> other) const {
+    Matrix<T, N, L, Layout> result{};
+    MatrixMultiplier<T>::Multiply(*this, other, result);
+    return result;
+  }
+
+  template <size_t L, MatrixLayout OtherLayout>
+  Matrix<T, N, L, Layout> operator*(const Matrix<T, M, L, OtherLayout>& other) const {
+    return *this * MatrixView<T, M, L, OtherLayout>(other);
+  }
+
+ private:
+  const T* data_;
+};
+
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+MatrixView<T, M, N, GetTransposedLayout(Layout)> GetTransposedView(MatrixView<T, N, M, Layout> view) {
+  return MatrixView<T, M, N, GetTransposedLayout(Layout)>(view.Data());
+}
+
+// The transpose of matrix as a view of its storage; matrix must outlive the view.
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+MatrixView<T, M, N, GetTransposedLayout(Layout)> GetTransposedView(const Matrix<T, N, M, Layout>& matrix) {
+  return GetTransposedView(MatrixView<T, N, M, Layout>(matrix));
+}
+
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+void GetTransposedView(const Matrix<T, N, M, Layout>&&) = delete;
+
+struct MatrixTileSizes {
+  size_t rows = 64;
+  size_t depth = 256;
+  size_t columns = 512;
+};
+
+// Tile sizes used by MultiplyAddBlocked for element type T (see autotune.h for choosing them at runtime).
+template <class T>
+MatrixTileSizes& GetMatrixTileSizes() {
+  static MatrixTileSizes tiles;
+  return tiles;
+}
+
+template <class T>
+void SetMatrixTileSizes(const MatrixTileSizes& tiles) {
+  if (tiles.rows == 0 || tiles.depth == 0 || tiles.columns == 0) {
+    throw std::invalid_argument("SetMatrixTileSizes(const MatrixTileSizes&)");
+  }
+  GetMatrixTileSizes<T>() = tiles;
 }
 
-template <class K, class T, size_t N, size_t M>
-Matrix<T, N, M> operator*(const K& k, const Matrix<T, N, M>& matrix) {
+// Name of T in the tile cache file of autotune.h, which together with sizeof(T) keeps apart element types whose kernels
+// differ. Element types with their own kernels specialize it where they are defined.
+template <class T>
+struct MatrixElementKind {
+  static constexpr const char* kName = std::is_floating_point_v<T> ? "float"
+                                       : std::is_integral_v<T>     ? (std::is_signed_v<T> ? "int" : "uint")
+                                                                   : "other";
+};
+
+// c (n x l) += a (n x m) * b (m x l), all row-major with the given row strides. The loops are tiled so that a block of
+// b stays in cache while rows of a stream through it, and the innermost loop runs over contiguous memory. Elements are
+// converted to the type of c before multiplying, which lets narrow operands accumulate in a wider type.
+template <class T, class U = T>
+void MultiplyAddBlocked(size_t n, size_t m, size_t l, const T* a, size_t lda, const T* b, size_t ldb, U* c, size_t ldc) {
+  const MatrixTileSizes tiles = GetMatrixTileSizes<T>();
+  for (size_t jj = 0; jj < l; jj += tiles.columns) {
+    size_t j_end = std::min(l, jj + tiles.columns);
+    for (size_t kk = 0; kk < m; kk += tiles.depth) {
+      size_t k_end = std::min(m, kk + tiles.depth);
+      for (size_t ii = 0; ii < n; ii += tiles.rows) {
+        size_t i_end = std::min(n, ii + tiles.rows);
+        for (size_t i = ii; i < i_end; i++) {
+          U* c_row = c + i * ldc;
+          for (size_t k = kk; k < k_end; k++) {
+            const U a_value = static_cast<U>(a[i * lda + k]);
+            const T* b_row = b + k * ldb;
+            for (size_t j = jj; j < j_end; j++) {
+              c_row[j] += a_value * static_cast<U>(b_row[j]);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// c (n x l) += a (n x m) * b (m x l) where b is given by its transpose bt (l x m, row-major), so that every element
+// of c is a dot product of two contiguous rows.
+template <class T, class U = T>
+void MultiplyAddDot(size_t n, size_t m, size_t l, const T* a, size_t lda, const T* bt, size_t ldbt, U* c, size_t ldc) {
+  const MatrixTileSizes tiles = GetMatrixTileSizes<T>();
+  for (size_t jj = 0; jj < l; jj += tiles.columns) {
+    size_t j_end = std::min(l, jj + tiles.columns);
+    for (size_t kk = 0; kk < m; kk += tiles.depth) {
+      size_t k_end = std::min(m, kk + tiles.depth);
+      for (size_t i = 0; i < n; i++) {
+        const T* a_row = a + i * lda;
+        for (size_t j = jj; j < j_end; j++) {
+          const T* bt_row = bt + j * ldbt;
+          U sum{};
+          for (size_t k = kk; k < k_end; k++) {
+            sum += static_cast<U>(a_row[k]) * static_cast<U>(bt_row[k]);
+          }
+          c[i * ldc + j] += sum;
+        }
+      }
+    }
+  }
+}
+
+// c (n x l) += a (n x m) * b (m x l) where a is given by its transpose at (m x n, row-major): a sum of outer products
+// of rows of at and rows of b.
+template <class T, class U = T>
+void MultiplyAddOuter(size_t n, size_t m, size_t l, const T* at, size_t ldat, const T* b, size_t ldb, U* c, size_t ldc) {
+  const MatrixTileSizes tiles = GetMatrixTileSizes<T>();
+  for (size_t jj = 0; jj < l; jj += tiles.columns) {
+    size_t j_end = std::min(l, jj + tiles.columns);
+    for (size_t kk = 0; kk < m; kk += tiles.depth) {
+      size_t k_end = std::min(m, kk + tiles.depth);
+      for (size_t ii = 0; ii < n; ii += tiles.rows) {
+        size_t i_end = std::min(n, ii + tiles.rows);
+        for (size_t k = kk; k < k_end; k++) {
+          const T* b_row = b + k * ldb;
+          for (size_t i = ii; i < i_end; i++) {
+            const U a_value = static_cast<U>(at[k * ldat + i]);
+            U* c_row = c + i * ldc;
+            for (size_t j = jj; j < j_end; j++) {
+              c_row[j] += a_value * static_cast<U>(b_row[j]);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// c (n x l) += a (n x m) * b (m x l) where both operands are given by their transposes at (m x n) and bt (l x m, both
+// row-major). Tiles of c^T = bt * at are computed by MultiplyAddBlocked into a per-thread buffer of the tile size and
+// added to c transposed, so that neither the operands nor the result are copied whole.
+template <class T, class U = T>
+void MultiplyAddTransposed(size_t n, size_t m, size_t l, const T* at, size_t ldat, const T* bt, size_t ldbt, U* c, size_t ldc) {
+  const MatrixTileSizes tiles = GetMatrixTileSizes<T>();
+  const size_t rows = std::min(l, tiles.rows);
+  const size_t columns = std::min(n, tiles.columns);
+  thread_local std::vector<U> buffer;
+  buffer.resize(rows * columns);
+  for (size_t jj = 0; jj < l; jj += rows) {
+    const size_t j_count = std::min(rows, l - jj);
+    for (size_t ii = 0; ii < n; ii += columns) {
+      const size_t i_count = std::min(columns, n - ii);
+      std::fill_n(buffer.data(), j_count * i_count, U{});
+      MultiplyAddBlocked(j_count, m, i_count, bt + jj * ldbt, ldbt, at + ii, ldat, buffer.data(), i_count);
+      for (size_t i = 0; i < i_count; i++) {
+        U* c_row = c + (ii + i) * ldc + jj;
+        for (size_t j = 0; j < j_count; j++) {
+          c_row[j] += buffer[j * i_count + i];
+        }
+      }
+    }
+  }
+}
+
+// c (n x l, row-major) += a (n x m) * b (m x l), where an operand in column-major layout is stored as its row-major
+// transpose. The loop order is chosen so that the innermost loop reads contiguous memory.
+template <MatrixLayout LayoutA, MatrixLayout LayoutB, class T, class U>
+void MultiplyAddToRowMajor(size_t n, size_t m, size_t l, const T* a, const T* b, U* c) {
+  constexpr auto kRowMajor = MatrixLayout::kRowMajor;
+  if constexpr (LayoutA == kRowMajor && LayoutB == kRowMajor) {
+    MultiplyAddBlocked(n, m, l, a, m, b, l, c, l);
+  } else if constexpr (LayoutA == kRowMajor) {
+    MultiplyAddDot(n, m, l, a, m, b, m, c, l);
+  } else if constexpr (LayoutB == kRowMajor) {
+    MultiplyAddOuter(n, m, l, a, n, b, l, c, l);
+  } else {
+    MultiplyAddTransposed(n, m, l, a, n, b, m, c, l);
+  }
+}
+
+// c += a * b for any combination of layouts. A column-major c is the row-major storage of c^T, computed as
+// c^T += b^T * a^T, where the storage of each operand serves as its transpose in the opposite layout.
+template <class T, class U, size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC>
+void MultiplyAddMatrices(MatrixView<T, N, M, LayoutA> a, MatrixView<T, M, L, LayoutB> b, Matrix<U, N, L, LayoutC>& c) {
+  if constexpr (LayoutC == MatrixLayout::kRowMajor) {
+    MultiplyAddToRowMajor<LayoutA, LayoutB>(N, M, L, a.Data(), b.Data(), &c.matrix[0][0]);
+  } else {
+    MultiplyAddToRowMajor<GetTransposedLayout(LayoutB), GetTransposedLayout(LayoutA)>(L, M, N, b.Data(), a.Data(), &c.matrix[0][0]);
+  }
+}
+
+template <class T>
+struct MatrixMultiplier {
+  template <size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC>
+  static void Multiply(MatrixView<T, N, M, LayoutA> a, MatrixView<T, M, L, LayoutB> b, Matrix<T, N, L, LayoutC>& result) {
+    MultiplyAddMatrices(a, b, result);
+  }
+};
+
+template <MatrixLayout NewLayout, class T, size_t N, size_t M, MatrixLayout Layout>
+Matrix<T, N, M, NewLayout> ToLayout(const Matrix<T, N, M, Layout>& matrix) {
+  if constexpr (NewLayout == Layout) {
+    return matrix;
+  } else {
+    Matrix<T, N, M, NewLayout> result;
+    for (size_t i = 0; i < result.kStorageRows; i++) {
+      for (size_t j = 0; j < result.kStorageColumns; j++) {
+        result.matrix[i][j] = matrix.matrix[j][i];
+      }
+    }
+    return result;
+  }
+}
+
+// The transpose in layout NewLayout. In the opposite layout the transpose has the same storage, which is copied as is.
+template <MatrixLayout NewLayout, class T, size_t N, size_t M, MatrixLayout Layout>
+Matrix<T, M, N, NewLayout> GetTransposed(const Matrix<T, N, M, Layout>& matrix) {
+  Matrix<T, M, N, NewLayout> result;
+  if constexpr (NewLayout != Layout) {
+    std::copy_n(&matrix.matrix[0][0], N * M, &result.matrix[0][0]);
+  } else {
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < M; j++) {
+        result(j, i) = matrix(i, j);
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+Matrix<T, M, N, Layout> GetTransposed(const Matrix<T, N, M, Layout>& matrix) {
+  return GetTransposed<Layout>(matrix);
+}
+
+template <class K, class T, size_t N, size_t M, MatrixLayout Layout>
+Matrix<T, N, M, Layout> operator*(const K& k, const Matrix<T, N, M, Layout>& matrix) {
   return matrix * k;
 }
 
-template <class T, size_t N, size_t M>
-bool operator==(const Matrix<T, N, M>& a, const Matrix<T, N, M>& b) {
+template <class T, size_t N, size_t M, MatrixLayout LayoutA, MatrixLayout LayoutB>
+bool operator==(const Matrix<T, N, M, LayoutA>& a, const Matrix<T, N, M, LayoutB>& b) {
   for (size_t i = 0; i < N; i++) {
     for (size_t j = 0; j < M; j++) {
       if (a(i, j) != b(i, j)) {
@@ -154,13 +449,13 @@ bool operator==(const Matrix<T, N, M>& a, const Matrix<T, N, M>& b) {
   return true;
 }
 
-template <class T, size_t N, size_t M>
-bool operator!=(const Matrix<T, N, M>& a, const Matrix<T, N, M>& b) {
+template <class T, size_t N, size_t M, MatrixLayout LayoutA, MatrixLayout LayoutB>
+bool operator!=(const Matrix<T, N, M, LayoutA>& a, const Matrix<T, N, M, LayoutB>& b) {
   return !(a == b);
 }
 
-template <class T, size_t N, size_t M>
-std::istream& operator>>(std::istream& in, Matrix<T, N, M>& matrix) {
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+std::istream& operator>>(std::istream& in, Matrix<T, N, M, Layout>& matrix) {
   for (size_t i = 0; i < N; i++) {
     for (size_t j = 0; j < M; j++) {
       in >> matrix(i, j);
@@ -169,8 +464,8 @@ std::istream& operator>>(std::istream& in, Matrix<T, N, M>& matrix) {
   return in;
 }
 
-template <class T, size_t N, size_t M>
-std::ostream& operator<<(std::ostream& out, const Matrix<T, N, M>& matrix) {
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+std::ostream& operator<<(std::ostream& out, const Matrix<T, N, M, Layout>& matrix) {
   for (size_t i = 0; i < N; i++) {
     out << matrix(i, 0);
     for (size_t j = 1; j < M; j++) {
@@ -183,8 +478,8 @@ std::ostream& operator<<(std::ostream& out, const Matrix<T, N, M>& matrix) {
 
 #define MATRIX_SQUARE_MATRIX_IMPLEMENTED
 
-template <class T, size_t N>
-void Transpose(Matrix<T, N, N>& matrix) {
+template <class T, size_t N, MatrixLayout Layout>
+void Transpose(Matrix<T, N, N, Layout>& matrix) {
   for (size_t i = 0; i < N; i++) {
     for (size_t j = i + 1; j < N; j++) {
       std::swap(matrix(i, j), matrix(j, i));
@@ -192,8 +487,8 @@ void Transpose(Matrix<T, N, N>& matrix) {
   }
 }
 
-template <class T, size_t N>
-T Trace(const Matrix<T, N, N>& matrix) {
+template <class T, size_t N, MatrixLayout Layout>
+T Trace(const Matrix<T, N, N, Layout>& matrix) {
   T result{};
   for (size_t i = 0; i < N; i++) {
     result += matrix(i, i);
@@ -201,9 +496,9 @@ T Trace(const Matrix<T, N, N>& matrix) {
   return std::move(result);
 }
 
-template <class T, size_t N>
-Matrix<T, N - 1, N - 1> Minor(const Matrix<T, N, N>& matrix, size_t row_number, size_t column_number) {
-  Matrix<T, N - 1, N - 1> result;
+template <class T, size_t N, MatrixLayout Layout>
+Matrix<T, N - 1, N - 1, Layout> Minor(const Matrix<T, N, N, Layout>& matrix, size_t row_number, size_t column_number) {
+  Matrix<T, N - 1, N - 1, Layout> result;
   for (size_t i = 0; i < N - 1; i++) {
     for (size_t j = 0; j < N - 1; j++) {
       result(i, j) = matrix(i < row_number ? i : i + 1, j < column_number ? j : j + 1);
@@ -212,13 +507,13 @@ Matrix<T, N - 1, N - 1> Minor(const Matrix<T, N, N>& matrix, size_t row_number,
   return std::move(result);
 }
 
-template <class T>
-T Determinant(const Matrix<T, 1, 1>& matrix) {
+template <class T, MatrixLayout Layout>
+T Determinant(const Matrix<T, 1, 1, Layout>& matrix) {
   return std::move(matrix(0, 0));
 }
 
-template <class T, size_t N>
-T Determinant(const Matrix<T, N, N>& matrix) {
+template <class T, size_t N, MatrixLayout Layout>
+T Determinant(const Matrix<T, N, N, Layout>& matrix) {
   T result{};
   for (size_t k = 0; k < N; k++) {
     result += Determinant(Minor(matrix, k, 0)) * matrix(k, 0) * (k % 2 == 0 ? 1 : -1);
@@ -226,8 +521,8 @@ T Determinant(const Matrix<T, N, N>& matrix) {
   return std::move(result);
 }
 
-template <class T>
-Matrix<T, 1, 1> GetInversed(const Matrix<T, 1, 1>& matrix) {
+template <class T, MatrixLayout Layout>
+Matrix<T, 1, 1, Layout> GetInversed(const Matrix<T, 1, 1, Layout>& matrix) {
   T determinant = Determinant(matrix);
   if (determinant == 0) {
     throw MatrixIsDegenerateError{};
@@ -235,13 +530,13 @@ Matrix<T, 1, 1> GetInversed(const Matrix<T, 1, 1>& matrix) {
   return {1 / determinant};
 }
 
-template <class T, size_t N>
-Matrix<T, N, N> GetInversed(const Matrix<T, N, N>& matrix) {
+template <class T, size_t N, MatrixLayout Layout>
+Matrix<T, N, N, Layout> GetInversed(const Matrix<T, N, N, Layout>& matrix) {
   T determinant = Determinant(matrix);
   if (determinant == 0) {
     throw MatrixIsDegenerateError{};
   }
-  Matrix<T, N, N> result;
+  Matrix<T, N, N, Layout> result;
   for (size_t i = 0; i < N; i++) {
     for (size_t j = 0; j < N; j++) {
       result(i, j) = Determinant(Minor(matrix, j, i)) / determinant * ((i + j) % 2 == 0 ? 1 : -1);
@@ -250,8 +545,8 @@ Matrix<T, N, N> GetInversed(const Matrix<T, N, N>& matrix) {
   return std::move(result);
 }
 
-template <class T, size_t N>
-void Inverse(Matrix<T, N, N>& matrix) {
+template <class T, size_t N, MatrixLayout Layout>
+void Inverse(Matrix<T, N, N, Layout>& matrix) {
   matrix = GetInversed(matrix);
 }
 
@@ -0,0 +1,76 @@
+#ifndef MATRIX_CHAIN_H_
+#define MATRIX_CHAIN_H_
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include "matrix.h"
+
+template <class Matrix>
+struct MatrixShape;
+
+template <class T, size_t N, size_t M, MatrixLayout Layout>
+struct MatrixShape<Matrix<T, N, M, Layout>> {
+  static constexpr size_t kRows = N;
+  static constexpr size_t kColumns = M;
+};
+
+// cost[i][j] is the smallest number of scalar multiplications needed for the product of operands i..j, and split[i][j]
+// is the last operand of the left factor in the best association of that product.
+template <size_t Count>
+struct MatrixChainPlan {
+  size_t cost[Count][Count];
+  size_t split[Count][Count];
+};
+
+// The classic O(Count^3) matrix-chain dynamic program; operand i is dims[i] x dims[i + 1].
+template <size_t Count>
+constexpr MatrixChainPlan<Count> GetMatrixChainPlan(const std::array<size_t, Count + 1>& dims) {
+  MatrixChainPlan<Count> plan{};
+  for (size_t length = 2; length <= Count; length++) {
+    for (size_t i = 0; i + length <= Count; i++) {
+      size_t j = i + length - 1;
+      plan.cost[i][j] = std::numeric_limits<size_t>::max();
+      for (size_t k = i; k < j; k++) {
+        size_t cost = plan.cost[i][k] + plan.cost[k + 1][j] + dims[i] * dims[k + 1] * dims[j + 1];
+        if (cost < plan.cost[i][j]) {
+          plan.cost[i][j] = cost;
+          plan.split[i][j] = k;
+        }
+      }
+    }
+  }
+  return plan;
+}
+
+template <class... Matrices>
+struct MatrixChain {
+  static constexpr size_t kCount = sizeof...(Matrices);
+  static constexpr std::array<size_t, kCount + 1> kDims = {
+      MatrixShape<std::tuple_element_t<0, std::tuple<Matrices...>>>::kRows, MatrixShape<Matrices>::kColumns...};
+  static constexpr MatrixChainPlan<kCount> kPlan = GetMatrixChainPlan<kCount>(kDims);
+
+  template <size_t I, size_t J, class Operands>
+  static decltype(auto) Multiply(const Operands& operands) {
+    if constexpr (I == J) {
+      return std::get<I>(operands);
+    } else {
+      constexpr size_t kSplit = kPlan.split[I][J];
+      return Multiply<I, kSplit>(operands) * Multiply<kSplit + 1, J>(operands);
+    }
+  }
+};
+
+// Product of the operands, associated so that the number of scalar multiplications is the smallest possible for
+// their compile-time shapes (left-to-right evaluation can be far worse, e.g. when the last operand is a vector).
+template <class... Matrices>
+auto MultiplyChain(const Matrices&... matrices) {
+  static_assert(sizeof...(Matrices) > 0, "MultiplyChain needs at least one matrix");
+  using Chain = MatrixChain<Matrices...>;
+  return Chain::template Multiply<0, Chain::kCount - 1>(std::tie(matrices...));
+}
+
+#endif
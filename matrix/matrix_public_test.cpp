@@ -3,10 +3,20 @@
 #include <catch.hpp>
 
 #include <array>
+#include <string_view>
 #include <type_traits>
 
 #include "matrix.h"
 #include "matrix.h"  // check include guards
+#include "rational_matrix.h"
+#include "tensor.h"
+#include "convolution.h"
+#include "autotune.h"
+#include "reduced_precision.h"
+#include "structured_matrix.h"
+#include "matrix_chain.h"
+#include "incremental_inverse.h"
+#include "qr.h"
 
 template <class T, size_t N, size_t M>
 void EqualMatrix(const Matrix<T, N, M> &matrix, const std::array<std::array<T, M>, N> &arr) {
@@ -141,3 +151,724 @@ TEST_CASE("SquareMatrix", "[Public]") {
 }
 
 #endif  // MATRIX_SQUARE_MATRIX_IMPLEMENTED
+
+TEST_CASE("RationalMatrix", "[Public]") {
+  auto naive = [](const auto& a, const auto& b, size_t i, size_t j, size_t depth) {
+    Rational result;
+    for (size_t k = 0; k < depth; k++) {
+      result += a(i, k) * b(k, j);
+    }
+    return result;
+  };
+
+  {
+    Matrix<Rational, 3, 4> a{};
+    Matrix<Rational, 4, 2> b{};
+    for (size_t i = 0; i < 3; i++) {
+      for (size_t k = 0; k < 4; k++) {
+        a(i, k) = Rational(static_cast<int64_t>(i * 7 + k * 3) - 5, static_cast<int64_t>(i + 2 * k + 1));
+      }
+    }
+    for (size_t k = 0; k < 4; k++) {
+      for (size_t j = 0; j < 2; j++) {
+        b(k, j) = Rational(static_cast<int64_t>(k * 5 + j) - 4, static_cast<int64_t>(3 * j + k + 2));
+      }
+    }
+    const auto product = a * b;
+    for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 2; j++) {
+        REQUIRE(product(i, j).GetNumerator() == naive(a, b, i, j, 4).GetNumerator());
+        REQUIRE(product(i, j).GetDenominator() == naive(a, b, i, j, 4).GetDenominator());
+      }
+    }
+  }
+
+  {
+    const Matrix<Rational, 2, 2> a{Rational(1, 2), Rational(-1, 3), Rational(0), Rational(5, 4)};
+    const Matrix<Rational, 2, 2> b{Rational(2), Rational(3, 2), Rational(-3), Rational(0)};
+    REQUIRE(a * b == Matrix<Rational, 2, 2>{Rational(2), Rational(3, 4), Rational(-15, 4), Rational(0)});
+  }
+
+  {
+    const int64_t p = 2147483647;  // coprime denominators whose common multiple does not fit into int64_t
+    const int64_t q = 2147483629;
+    const int64_t r = 2147483587;
+    const Matrix<Rational, 1, 3> a{Rational(1, p), Rational(1, q), Rational(1, r)};
+    const Matrix<Rational, 3, 1> b{Rational(p), Rational(q), Rational(r)};
+    REQUIRE((a * b)(0, 0) == Rational(3));
+  }
+}
+
+TEST_CASE("Tensor", "[Public]") {
+  static_assert(sizeof(Tensor<int, 2, 3, 4>) == sizeof(int) * 24);
+
+  Tensor<int, 2, 3, 4> a{};
+  for (size_t i = 0; i < 24; i++) {
+    a.tensor[i] = static_cast<int>(i);
+  }
+  REQUIRE(a.Rank() == 3);
+  REQUIRE(a.Size() == 24);
+  REQUIRE(a(1, 2, 3) == 23);
+  REQUIRE(std::as_const(a)(0, 1, 2) == 6);
+  REQUIRE_THROWS_AS(a.At(0, 3, 0), TensorOutOfRange);  // NOLINT
+
+  auto permuted = Permute<2, 0, 1>(a);
+  REQUIRE(permuted(3, 1, 2) == a(1, 2, 3));
+  REQUIRE(permuted(2, 0, 1) == a(0, 1, 2));
+  REQUIRE(!decltype(permuted)::kContiguous);
+  permuted(0, 0, 0) = 100;
+  REQUIRE(a(0, 0, 0) == 100);
+
+  auto reshaped = Reshape<6, 4>(a);
+  REQUIRE(reshaped(5, 3) == a(1, 2, 3));
+  REQUIRE(reshaped.Data() == a.Data());
+
+  Tensor<int, 4, 3, 5> b{};
+  for (size_t i = 0; i < 60; i++) {
+    b.tensor[i] = static_cast<int>(i % 7) - 3;
+  }
+
+  // c[i][l][m] = sum_{j, k} a[i][j][k] * b[k][j][m]
+  const auto c = Contract<std::index_sequence<1, 2>, std::index_sequence<1, 0>>(a, b);
+  static_assert(std::is_same_v<std::remove_const_t<decltype(c)>, Tensor<int, 2, 5>>);
+  for (size_t i = 0; i < 2; i++) {
+    for (size_t m = 0; m < 5; m++) {
+      int expected = 0;
+      for (size_t j = 0; j < 3; j++) {
+        for (size_t k = 0; k < 4; k++) {
+          expected += a(i, j, k) * b(k, j, m);
+        }
+      }
+      REQUIRE(c(i, m) == expected);
+    }
+  }
+
+  // contraction over a permuted view and the last-K/first-K shorthand
+  const auto d = Contract<1>(Permute<0, 2, 1>(a), Reshape<3, 20>(b));
+  static_assert(std::is_same_v<std::remove_const_t<decltype(d)>, Tensor<int, 2, 4, 20>>);
+  for (size_t i = 0; i < 2; i++) {
+    for (size_t k = 0; k < 4; k++) {
+      for (size_t n = 0; n < 20; n++) {
+        int expected = 0;
+        for (size_t j = 0; j < 3; j++) {
+          expected += a(i, j, k) * b.tensor[j * 20 + n];
+        }
+        REQUIRE(d(i, k, n) == expected);
+      }
+    }
+  }
+
+  const Matrix<int, 2, 3> x{1, 2, 3, 4, 5, 6};
+  const Matrix<int, 3, 2> y{1, -1, 0, 2, 3, 1};
+  REQUIRE(ToMatrix(Contract<1>(ToTensor(x), ToTensor(y))) == x * y);
+  REQUIRE(Contract<2>(ToTensor(x), ToTensor(x))() == 91);
+}
+
+template <size_t Stride, size_t Padding, class T, size_t H, size_t W, size_t KH, size_t KW>
+T NaiveConvolution(const Matrix<T, H, W>& input, const Matrix<T, KH, KW>& kernel, size_t oy, size_t ox) {
+  T result{};
+  for (size_t u = 0; u < KH; u++) {
+    for (size_t v = 0; v < KW; v++) {
+      auto y = static_cast<int64_t>(oy * Stride + u) - static_cast<int64_t>(Padding);
+      auto x = static_cast<int64_t>(ox * Stride + v) - static_cast<int64_t>(Padding);
+      if (y >= 0 && y < static_cast<int64_t>(H) && x >= 0 && x < static_cast<int64_t>(W)) {
+        result += input(y, x) * kernel(u, v);
+      }
+    }
+  }
+  return result;
+}
+
+TEST_CASE("Convolution", "[Public]") {
+  Matrix<int, 9, 11> input{};
+  for (size_t i = 0; i < 9; i++) {
+    for (size_t j = 0; j < 11; j++) {
+      input(i, j) = static_cast<int>((i * 11 + j) % 13) - 6;
+    }
+  }
+  Matrix<int, 3, 4> small{};
+  Matrix<int, 6, 7> large{};
+  for (size_t i = 0; i < 12; i++) {
+    small.matrix[i / 4][i % 4] = static_cast<int>(i % 5) - 2;
+  }
+  for (size_t i = 0; i < 42; i++) {
+    large.matrix[i / 7][i % 7] = static_cast<int>(i % 3) - 1;
+  }
+
+  {
+    const auto result = Convolve(input, small);
+    static_assert(std::is_same_v<std::remove_const_t<decltype(result)>, Matrix<int, 7, 8>>);
+    for (size_t i = 0; i < 7; i++) {
+      for (size_t j = 0; j < 8; j++) {
+        REQUIRE(result(i, j) == NaiveConvolution<1, 0>(input, small, i, j));
+      }
+    }
+    REQUIRE(result == Convolve(input, small, ConvolutionAlgorithm::kIm2col));
+  }
+
+  {
+    const auto result = Convolve<2, 1>(input, small);
+    static_assert(std::is_same_v<std::remove_const_t<decltype(result)>, Matrix<int, 5, 5>>);
+    for (size_t i = 0; i < 5; i++) {
+      for (size_t j = 0; j < 5; j++) {
+        REQUIRE(result(i, j) == NaiveConvolution<2, 1>(input, small, i, j));
+      }
+    }
+    REQUIRE(result == Convolve<2, 1>(input, small, ConvolutionAlgorithm::kIm2col));
+  }
+
+  {
+    const auto result = Convolve<3, 2>(input, large);
+    static_assert(std::is_same_v<std::remove_const_t<decltype(result)>, Matrix<int, 3, 3>>);
+    for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 3; j++) {
+        REQUIRE(result(i, j) == NaiveConvolution<3, 2>(input, large, i, j));
+      }
+    }
+    REQUIRE(result == Convolve<3, 2>(input, large, ConvolutionAlgorithm::kDirect));
+    auto fft = [&] { return Convolve<3, 2>(input, large, ConvolutionAlgorithm::kFft); };
+    REQUIRE_THROWS_AS(fft(), std::invalid_argument);  // NOLINT
+  }
+
+  {
+    Matrix<double, 9, 11> real_input{};
+    Matrix<double, 6, 7> real_kernel{};
+    for (size_t i = 0; i < 99; i++) {
+      real_input.matrix[i / 11][i % 11] = input.matrix[i / 11][i % 11] * 0.5;
+    }
+    for (size_t i = 0; i < 42; i++) {
+      real_kernel.matrix[i / 7][i % 7] = large.matrix[i / 7][i % 7] * 0.25;
+    }
+    const auto fft = Convolve<1, 2>(real_input, real_kernel, ConvolutionAlgorithm::kFft);
+    const auto im2col = Convolve<1, 2>(real_input, real_kernel, ConvolutionAlgorithm::kIm2col);
+    for (size_t i = 0; i < fft.RowsNumber(); i++) {
+      for (size_t j = 0; j < fft.ColumnsNumber(); j++) {
+        REQUIRE(fft(i, j) == Approx(NaiveConvolution<1, 2>(real_input, real_kernel, i, j)).margin(1e-9));
+        REQUIRE(im2col(i, j) == Approx(NaiveConvolution<1, 2>(real_input, real_kernel, i, j)).margin(1e-9));
+      }
+    }
+  }
+}
+
+TEST_CASE("Autotune", "[Public]") {
+  const auto caches = DetectCacheSizes();
+  REQUIRE(caches.l1 > 0);
+  REQUIRE(caches.l2 >= caches.l1);
+
+  const auto heuristic = GetHeuristicTileSizes<double>(caches);
+  REQUIRE(heuristic.rows > 0);
+  REQUIRE(heuristic.depth > 0);
+  REQUIRE(heuristic.columns > 0);
+
+  const std::string path = "matrix_tiles_test_cache";
+  std::remove(path.c_str());
+  static_assert(std::string_view(MatrixElementKind<int>::kName) != MatrixElementKind<float>::kName);
+  static_assert(std::string_view(MatrixElementKind<Half>::kName) != MatrixElementKind<BFloat16>::kName);
+  MatrixTilesEntry entry{"float", sizeof(double), false, {}};
+  REQUIRE(!LoadMatrixTileSizes(path, caches, entry));
+  REQUIRE(SaveMatrixTileSizes(path, caches, {"float", sizeof(double), true, {3, 5, 7}}));
+  REQUIRE(SaveMatrixTileSizes(path, caches, {"float", sizeof(float), false, {8, 16, 32}}));
+  REQUIRE(LoadMatrixTileSizes(path, caches, entry));
+  REQUIRE(entry.measured);
+  REQUIRE((entry.tiles.rows == 3 && entry.tiles.depth == 5 && entry.tiles.columns == 7));
+  REQUIRE(!LoadMatrixTileSizes(path, CacheSizes{1, 2, 3}, entry));
+
+  // int has the size of float but gets its own entry
+  const auto int_heuristic = GetHeuristicTileSizes<int>(caches);
+  const auto int_tiles = AutotuneMatrixKernel<int>(false, path);
+  REQUIRE((int_tiles.rows == int_heuristic.rows && int_tiles.columns == int_heuristic.columns));
+  REQUIRE(GetMatrixTileSizes<int>().columns == int_heuristic.columns);
+  MatrixTilesEntry float_entry{"float", sizeof(float), false, {}};
+  REQUIRE(LoadMatrixTileSizes(path, caches, float_entry));
+  REQUIRE(float_entry.tiles.columns == 32);
+  REQUIRE(AutotuneMatrixKernel<float>(false, path).columns == 32);
+
+  // a heuristic entry is measured and replaced when measuring is asked for
+  MatrixTilesEntry int_entry{MatrixElementKind<int>::kName, sizeof(int), false, {}};
+  REQUIRE(LoadMatrixTileSizes(path, caches, int_entry));
+  REQUIRE(!int_entry.measured);
+  const auto measured_int = AutotuneMatrixKernel<int>(true, path);
+  REQUIRE(LoadMatrixTileSizes(path, caches, int_entry));
+  REQUIRE(int_entry.measured);
+  REQUIRE((int_entry.tiles.rows == measured_int.rows && int_entry.tiles.columns == measured_int.columns));
+  REQUIRE(AutotuneMatrixKernel<int>(false, path).columns == measured_int.columns);
+
+  // Half and BFloat16 have the same size but separate entries
+  REQUIRE(SaveMatrixTileSizes(path, caches, {MatrixElementKind<Half>::kName, sizeof(Half), true, {2, 4, 8}}));
+  REQUIRE(AutotuneMatrixKernel<Half>(false, path).columns == 8);
+  REQUIRE(AutotuneMatrixKernel<BFloat16>(false, path).columns == GetHeuristicTileSizes<BFloat16>(caches).columns);
+  SetMatrixTileSizes<Half>({});
+  SetMatrixTileSizes<BFloat16>({});
+
+  // tiles that do not divide the matrix sizes must give the same product
+  SetMatrixTileSizes<int>({3, 5, 7});
+  Matrix<int, 10, 13> a{};
+  Matrix<int, 13, 11> b{};
+  for (size_t i = 0; i < 130; i++) {
+    a.matrix[i / 13][i % 13] = static_cast<int>(i % 9) - 4;
+  }
+  for (size_t i = 0; i < 143; i++) {
+    b.matrix[i / 11][i % 11] = static_cast<int>(i % 7) - 3;
+  }
+  const auto product = a * b;
+  for (size_t i = 0; i < 10; i++) {
+    for (size_t j = 0; j < 11; j++) {
+      int expected = 0;
+      for (size_t k = 0; k < 13; k++) {
+        expected += a(i, k) * b(k, j);
+      }
+      REQUIRE(product(i, j) == expected);
+    }
+  }
+  SetMatrixTileSizes<int>({});
+  REQUIRE_THROWS_AS(SetMatrixTileSizes<int>({0, 1, 1}), std::invalid_argument);  // NOLINT
+
+  const auto measured = MeasureTileSizes<float>(caches, 64);
+  REQUIRE(measured.rows > 0);
+  REQUIRE(MeasureTileSizes<Half>(caches, 32).rows > 0);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("ReducedPrecision", "[Public]") {
+  static_assert(sizeof(Matrix<Half, 4, 8>) == 64);
+  static_assert(sizeof(Matrix<BFloat16, 4, 8>) == 64);
+
+  REQUIRE(Half(1.f).GetBits() == 0x3C00);
+  REQUIRE(Half(-2.f).GetBits() == 0xC000);
+  REQUIRE(Half(65504.f).GetBits() == 0x7BFF);
+  REQUIRE(Half(65536.f).GetBits() == 0x7C00);
+  REQUIRE(Half(std::ldexp(1.f, -24)).GetBits() == 0x0001);
+  REQUIRE(Half(std::ldexp(1.f, -26)).GetBits() == 0x0000);
+  REQUIRE(Half(1.f + std::ldexp(1.f, -11)).GetBits() == 0x3C00);  // ties to even
+  REQUIRE(Half(1.f + 3 * std::ldexp(1.f, -11)).GetBits() == 0x3C02);
+  REQUIRE(static_cast<float>(Half::FromBits(0x0001)) == std::ldexp(1.f, -24));
+  REQUIRE(static_cast<float>(Half::FromBits(0x3555)) == Approx(1.f / 3).epsilon(1e-3));
+  REQUIRE(std::isinf(static_cast<float>(Half::FromBits(0xFC00))));
+  REQUIRE(std::isnan(static_cast<float>(Half(NAN))));
+
+  REQUIRE(BFloat16(1.f).GetBits() == 0x3F80);
+  REQUIRE(BFloat16(-3.f).GetBits() == 0xC040);
+  REQUIRE(static_cast<float>(BFloat16(1.f / 3)) == Approx(1.f / 3).epsilon(1e-2));
+  REQUIRE(std::isnan(static_cast<float>(BFloat16(NAN))));
+
+  Matrix<float, 3, 5> a{};
+  Matrix<float, 5, 4> b{};
+  for (size_t i = 0; i < 15; i++) {
+    a.matrix[i / 5][i % 5] = static_cast<float>(i % 7) * 0.25f - 0.5f;
+  }
+  for (size_t i = 0; i < 20; i++) {
+    b.matrix[i / 4][i % 4] = static_cast<float>(i % 5) * 0.5f - 1.f;
+  }
+  const auto expected = a * b;
+
+  const auto half = MatrixCast<Half>(a) * MatrixCast<Half>(b);
+  const auto wide = MultiplyWide(MatrixCast<BFloat16>(a), MatrixCast<BFloat16>(b));
+  static_assert(std::is_same_v<std::remove_const_t<decltype(half)>, Matrix<Half, 3, 4>>);
+  static_assert(std::is_same_v<std::remove_const_t<decltype(wide)>, Matrix<float, 3, 4>>);
+  const auto quantized = Quantize(a) * Quantize(b);
+  for (size_t i = 0; i < 3; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      REQUIRE(static_cast<float>(half(i, j)) == expected(i, j));  // exactly representable values
+      REQUIRE(wide(i, j) == expected(i, j));
+      REQUIRE(quantized(i, j) == Approx(expected(i, j)).margin(0.05));
+    }
+  }
+
+  {
+    // the widened kernel with tiles that do not divide the sizes, for every operand and result layout
+    constexpr auto kColumnMajor = MatrixLayout::kColumnMajor;
+    SetMatrixTileSizes<Half>({2, 3, 3});
+    const auto half_a = MatrixCast<Half>(a);
+    const auto half_b = MatrixCast<Half>(b);
+    const auto expected_half = MatrixCast<Half>(expected);
+    REQUIRE(half_a * half_b == expected_half);
+    REQUIRE(ToLayout<kColumnMajor>(half_a) * half_b == expected_half);
+    REQUIRE(half_a * ToLayout<kColumnMajor>(half_b) == expected_half);
+    REQUIRE(ToLayout<kColumnMajor>(half_a) * ToLayout<kColumnMajor>(half_b) == expected_half);
+    Matrix<float, 3, 4, kColumnMajor> sum{};
+    MultiplyAddWidened(half_a, ToLayout<kColumnMajor>(half_b), sum);
+    MultiplyAddWidened(half_a, half_b, sum);
+    REQUIRE(sum == expected * 2.f);
+    SetMatrixTileSizes<Half>({});
+  }
+
+  const Matrix<int8_t, 2, 2> x{100, 100, -100, 100};
+  const auto products = MultiplyWide(x, x);
+  REQUIRE(products(0, 0) == 0);
+  REQUIRE(products(0, 1) == 20000);
+  REQUIRE(Dequantize(Quantize(a))(2, 4) == Approx(a(2, 4)).margin(0.01));
+}
+
+TEST_CASE("StructuredMatrix", "[Public]") {
+  static_assert(sizeof(SymmetricMatrix<double, 4>) == sizeof(double) * 10);
+  static_assert(sizeof(UpperTriangularMatrix<double, 4>) == sizeof(double) * 10);
+  static_assert(sizeof(DiagonalMatrix<double, 4>) == sizeof(double) * 4);
+  static_assert(sizeof(BandedMatrix<double, 6, 1, 2>) == sizeof(double) * 24);
+
+  Matrix<int, 4, 4> dense{};
+  Matrix<int, 4, 3> b{};
+  for (size_t i = 0; i < 16; i++) {
+    dense.matrix[i / 4][i % 4] = static_cast<int>(i % 7) - 2;
+  }
+  for (size_t i = 0; i < 12; i++) {
+    b.matrix[i / 3][i % 3] = static_cast<int>(i % 5) - 1;
+  }
+  const Matrix<int, 3, 4> c = GetTransposed(b);
+
+  {
+    const auto diagonal = ToDiagonal(dense);
+    const auto full = ToMatrix(diagonal);
+    REQUIRE(full(1, 1) == dense(1, 1));
+    REQUIRE(full(1, 2) == 0);
+    REQUIRE(diagonal * b == full * b);
+    REQUIRE(c * diagonal == c * full);
+    REQUIRE(ToMatrix(diagonal * diagonal) == full * full);
+    REQUIRE(Determinant(diagonal) == Determinant(full));
+    REQUIRE_THROWS_AS(ToDiagonal(dense).At(0, 1), MatrixOutOfRange);  // NOLINT
+  }
+
+  {
+    auto symmetric = ToSymmetric(dense);
+    const auto full = ToMatrix(symmetric);
+    REQUIRE(full == GetTransposed(full));
+    REQUIRE(full(3, 1) == dense(3, 1));
+    REQUIRE(full(1, 3) == dense(3, 1));
+    REQUIRE(symmetric * b == full * b);
+    REQUIRE(c * symmetric == c * full);
+    REQUIRE(Determinant(symmetric) == Determinant(full));
+    symmetric(0, 2) = 42;
+    REQUIRE(symmetric(2, 0) == 42);
+    REQUIRE(ToMatrix(GetTransposed(symmetric)) == ToMatrix(symmetric));
+  }
+
+  {
+    const auto upper = ToUpperTriangular(dense);
+    const auto lower = ToLowerTriangular(dense);
+    const auto full_upper = ToMatrix(upper);
+    const auto full_lower = ToMatrix(lower);
+    REQUIRE(full_upper(0, 3) == dense(0, 3));
+    REQUIRE(full_upper(3, 0) == 0);
+    REQUIRE(full_lower(3, 0) == dense(3, 0));
+    REQUIRE(full_lower(0, 3) == 0);
+    REQUIRE(upper * b == full_upper * b);
+    REQUIRE(lower * b == full_lower * b);
+    REQUIRE(c * upper == c * full_upper);
+    REQUIRE(c * lower == c * full_lower);
+    REQUIRE(ToMatrix(upper * upper) == full_upper * full_upper);
+    REQUIRE(ToMatrix(lower * lower) == full_lower * full_lower);
+    REQUIRE(Determinant(upper) == Determinant(full_upper));
+    REQUIRE(ToMatrix(GetTransposed(upper)) == GetTransposed(full_upper));
+    REQUIRE(ToMatrix(GetTransposed(lower)) == GetTransposed(full_lower));
+    REQUIRE_THROWS_AS(ToUpperTriangular(dense).At(2, 1), MatrixOutOfRange);  // NOLINT
+  }
+
+  {
+    Matrix<double, 4, 4> real{};
+    Matrix<double, 4, 2> rhs{};
+    for (size_t i = 0; i < 16; i++) {
+      real.matrix[i / 4][i % 4] = (i % 5 == 0 ? 4.0 : 0.5) + static_cast<double>(i % 3);
+    }
+    for (size_t i = 0; i < 8; i++) {
+      rhs.matrix[i / 2][i % 2] = static_cast<double>(i) - 3.5;
+    }
+    const auto upper = ToUpperTriangular(real);
+    const auto lower = ToLowerTriangular(real);
+    const auto x = Solve(upper, rhs);
+    const auto y = Solve(lower, rhs);
+    const auto z = Solve(ToDiagonal(real), rhs);
+    const auto upper_check = upper * x;
+    const auto lower_check = lower * y;
+    const auto diagonal_check = ToDiagonal(real) * z;
+    for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 2; j++) {
+        REQUIRE(upper_check(i, j) == Approx(rhs(i, j)));
+        REQUIRE(lower_check(i, j) == Approx(rhs(i, j)));
+        REQUIRE(diagonal_check(i, j) == Approx(rhs(i, j)));
+      }
+    }
+    REQUIRE_THROWS_AS(Solve(UpperTriangularMatrix<double, 4>{}, rhs), MatrixIsDegenerateError);  // NOLINT
+  }
+
+  {
+    Matrix<int, 6, 6> wide{};
+    Matrix<int, 6, 2> rhs{};
+    for (size_t i = 0; i < 36; i++) {
+      wide.matrix[i / 6][i % 6] = static_cast<int>(i % 7) - 3;
+    }
+    for (size_t i = 0; i < 12; i++) {
+      rhs.matrix[i / 2][i % 2] = static_cast<int>(i % 4) - 1;
+    }
+    const auto banded = ToBanded<1, 2>(wide);
+    const auto full = ToMatrix(banded);
+    REQUIRE(full(3, 2) == wide(3, 2));
+    REQUIRE(full(3, 5) == wide(3, 5));
+    REQUIRE(full(3, 1) == 0);
+    REQUIRE(full(0, 3) == 0);
+    REQUIRE(banded * rhs == full * rhs);
+    REQUIRE(GetTransposed(rhs) * banded == GetTransposed(rhs) * full);
+    REQUIRE(ToMatrix(GetTransposed(banded)) == GetTransposed(full));
+    REQUIRE(Determinant(banded) == Determinant(full));
+  }
+}
+
+template <MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC, class T, size_t N, size_t M, size_t L>
+void CheckLayoutProduct(const Matrix<T, N, M>& a, const Matrix<T, M, L>& b) {
+  const auto expected = a * b;
+  const auto layout_a = ToLayout<LayoutA>(a);
+  const auto layout_b = ToLayout<LayoutB>(b);
+  Matrix<T, N, L, LayoutC> result{};
+  MatrixMultiplier<T>::Multiply(MatrixView(layout_a), MatrixView(layout_b), result);
+  REQUIRE(result == expected);
+  REQUIRE(layout_a * layout_b == expected);
+  REQUIRE(GetTransposedView(GetTransposedView(layout_a)) * layout_b == expected);
+  REQUIRE(GetTransposed(GetTransposedView(layout_b) * GetTransposedView(layout_a)) == expected);
+}
+
+TEST_CASE("Layout", "[Public]") {
+  constexpr auto kRowMajor = MatrixLayout::kRowMajor;
+  constexpr auto kColumnMajor = MatrixLayout::kColumnMajor;
+
+  {
+    const Matrix<int, 2, 3, kColumnMajor> matrix{1, 4, 2, 5, 3, 6};
+    REQUIRE(matrix.RowsNumber() == 2);
+    REQUIRE(matrix.ColumnsNumber() == 3);
+    REQUIRE(matrix(0, 2) == 3);
+    REQUIRE(matrix(1, 0) == 4);
+    REQUIRE_THROWS_AS(matrix.At(2, 0), MatrixOutOfRange);  // NOLINT
+    REQUIRE(matrix == Matrix<int, 2, 3>{1, 2, 3, 4, 5, 6});
+    REQUIRE(ToLayout<kRowMajor>(matrix).matrix[0][2] == 3);
+    REQUIRE(ToLayout<kColumnMajor>(ToLayout<kRowMajor>(matrix)).matrix[2][0] == 3);
+    REQUIRE(GetTransposed(matrix) == Matrix<int, 3, 2>{1, 4, 2, 5, 3, 6});
+    REQUIRE((matrix + matrix) * 2 == 4 * matrix);
+  }
+
+  {
+    const Matrix<int, 2, 3> matrix{1, 2, 3, 4, 5, 6};
+    const auto view = GetTransposedView(matrix);
+    static_assert(std::is_same_v<decltype(view), const MatrixView<int, 3, 2, kColumnMajor>>);
+    REQUIRE(view.Data() == &matrix.matrix[0][0]);
+    REQUIRE(view.RowsNumber() == 3);
+    REQUIRE(view(2, 1) == 6);
+    REQUIRE(view.At(0, 1) == 4);
+    REQUIRE_THROWS_AS(view.At(3, 0), MatrixOutOfRange);  // NOLINT
+    const auto transposed = GetTransposed<kColumnMajor>(matrix);
+    REQUIRE(transposed == GetTransposed(matrix));
+    REQUIRE(std::equal(&matrix.matrix[0][0], &matrix.matrix[0][0] + 6, &transposed.matrix[0][0]));
+    REQUIRE(view * matrix == GetTransposed(matrix) * matrix);
+    REQUIRE(matrix * view == matrix * GetTransposed(matrix));
+  }
+
+  {
+    Matrix<int, 7, 5> a{};
+    Matrix<int, 5, 6> b{};
+    for (size_t i = 0; i < 35; i++) {
+      a.matrix[i / 5][i % 5] = static_cast<int>(i % 11) - 5;
+    }
+    for (size_t i = 0; i < 30; i++) {
+      b.matrix[i / 6][i % 6] = static_cast<int>(i % 7) - 3;
+    }
+    const MatrixTileSizes saved = GetMatrixTileSizes<int>();
+    for (const MatrixTileSizes& tiles : {saved, MatrixTileSizes{2, 3, 4}}) {
+      SetMatrixTileSizes<int>(tiles);
+      CheckLayoutProduct<kRowMajor, kRowMajor, kRowMajor>(a, b);
+      CheckLayoutProduct<kRowMajor, kColumnMajor, kRowMajor>(a, b);
+      CheckLayoutProduct<kColumnMajor, kRowMajor, kRowMajor>(a, b);
+      CheckLayoutProduct<kColumnMajor, kColumnMajor, kRowMajor>(a, b);
+      CheckLayoutProduct<kRowMajor, kRowMajor, kColumnMajor>(a, b);
+      CheckLayoutProduct<kRowMajor, kColumnMajor, kColumnMajor>(a, b);
+      CheckLayoutProduct<kColumnMajor, kRowMajor, kColumnMajor>(a, b);
+      CheckLayoutProduct<kColumnMajor, kColumnMajor, kColumnMajor>(a, b);
+    }
+    SetMatrixTileSizes<int>(saved);
+  }
+
+  {
+    const Matrix<Rational, 2, 2, kColumnMajor> a{Rational(1, 2), Rational(1, 3), 1, Rational(-1, 4)};
+    const Matrix<Rational, 2, 2> b{Rational(2, 5), 1, 3, Rational(1, 7)};
+    REQUIRE(a * b == ToLayout<kRowMajor>(a) * b);
+    REQUIRE(Determinant(a) == Determinant(ToLayout<kRowMajor>(a)));
+    REQUIRE(GetInversed(a) == GetInversed(ToLayout<kRowMajor>(a)));
+    REQUIRE(Trace(a) == Rational(1, 4));
+  }
+
+  {
+    const Matrix<float, 2, 3> a{1.5f, -2, 0.25f, 3, 1, -1};
+    const Matrix<float, 3, 2> b{2, 1, 0.5f, -1, 4, 0.75f};
+    const auto expected = MatrixCast<Half>(a * b);
+    REQUIRE(ToLayout<kColumnMajor>(MatrixCast<Half>(a)) * MatrixCast<Half>(b) == ToLayout<kColumnMajor>(expected));
+  }
+}
+
+TEST_CASE("MatrixChain", "[Public]") {
+  {
+    constexpr auto plan = GetMatrixChainPlan<3>({10, 100, 5, 50});
+    static_assert(plan.cost[0][2] == 7500);
+    static_assert(plan.split[0][2] == 1);
+    constexpr auto vector_plan = GetMatrixChainPlan<4>({30, 40, 50, 60, 1});
+    static_assert(vector_plan.split[0][3] == 0 && vector_plan.split[1][3] == 1 && vector_plan.split[2][3] == 2);
+    static_assert(vector_plan.cost[0][3] == 3000 + 2000 + 1200);
+  }
+
+  {
+    Matrix<int, 6, 8> a{};
+    Matrix<int, 8, 7, MatrixLayout::kColumnMajor> b{};
+    Matrix<int, 7, 9> c{};
+    Matrix<int, 9, 1> d{};
+    for (size_t i = 0; i < 6; i++) {
+      for (size_t j = 0; j < 8; j++) {
+        a(i, j) = static_cast<int>((i * 3 + j) % 5) - 2;
+      }
+    }
+    for (size_t i = 0; i < 8; i++) {
+      for (size_t j = 0; j < 7; j++) {
+        b(i, j) = static_cast<int>((i + j * 2) % 7) - 3;
+      }
+    }
+    for (size_t i = 0; i < 7; i++) {
+      for (size_t j = 0; j < 9; j++) {
+        c(i, j) = static_cast<int>((i * j) % 4) - 1;
+      }
+    }
+    for (size_t i = 0; i < 9; i++) {
+      d(i, 0) = static_cast<int>(i) - 4;
+    }
+    const auto product = MultiplyChain(a, b, c, d);
+    static_assert(std::is_same_v<decltype(product), const Matrix<int, 6, 1>>);
+    REQUIRE(product == a * b * c * d);
+    REQUIRE(MultiplyChain(a, b) == a * b);
+    REQUIRE(MultiplyChain(d) == d);
+    static_assert(MatrixChain<decltype(a), decltype(b), decltype(c), decltype(d)>::kPlan.split[0][3] == 0);
+  }
+}
+
+template <size_t N>
+void CheckIncrementalInverse(const IncrementalInverse<double, N>& incremental) {
+  const auto inversed = GetInversed(incremental.GetMatrix());
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < N; j++) {
+      REQUIRE(incremental.GetInversed()(i, j) == Approx(inversed(i, j)).margin(1e-9));
+    }
+  }
+  REQUIRE(incremental.GetDeterminant() == Approx(Determinant(incremental.GetMatrix())));
+}
+
+TEST_CASE("IncrementalInverse", "[Public]") {
+  {
+    const Matrix<double, 4, 4> matrix{4, 1, 0, 2, 1, 5, 1, 0, 0, 2, 6, 1, 1, 0, 1, 3};
+    IncrementalInverse<double, 4> incremental(matrix);
+    CheckIncrementalInverse(incremental);
+    REQUIRE(incremental.GetResidual() < 1e-12);
+
+    incremental.SetRow(2, Matrix<double, 1, 4>{1, -1, 7, 2});
+    REQUIRE(incremental.GetMatrix()(2, 2) == 7);
+    REQUIRE(incremental.UpdatesSinceRefactorization() == 1);
+    CheckIncrementalInverse(incremental);
+
+    incremental.SetColumn(0, Matrix<double, 4, 1>{3, 2, -1, 1});
+    REQUIRE(incremental.GetMatrix()(1, 0) == 2);
+    CheckIncrementalInverse(incremental);
+
+    incremental.UpdateRank1(Matrix<double, 4, 1>{1, 0, 2, 0}, Matrix<double, 1, 4>{0.5, 1, 0, -1});
+    CheckIncrementalInverse(incremental);
+
+    incremental.Update(Matrix<double, 4, 2>{1, 0, 0, 1, 1, 1, 0, -1}, Matrix<double, 2, 4>{0.25, 0, 1, 0, 0, -0.5, 0, 1});
+    REQUIRE(incremental.UpdatesSinceRefactorization() == 4);
+    CheckIncrementalInverse(incremental);
+
+    REQUIRE_THROWS_AS(incremental.SetRow(4, Matrix<double, 1, 4>{}), MatrixOutOfRange);  // NOLINT
+  }
+
+  {
+    IncrementalInverse<double, 3> incremental(Matrix<double, 3, 3>{1, 0, 0, 0, 1, 0, 0, 0, 1});
+    REQUIRE(incremental.GetDeterminant() == 1);
+    REQUIRE_THROWS_AS(incremental.SetRow(1, Matrix<double, 1, 3>{1, 0, 0}), MatrixIsDegenerateError);  // NOLINT
+    REQUIRE(incremental.GetMatrix() == Matrix<double, 3, 3>{1, 0, 0, 0, 1, 0, 0, 0, 1});
+    REQUIRE(incremental.GetInversed() == incremental.GetMatrix());
+
+    // nearly singular intermediate state: the update is applied by refactorizing instead
+    incremental.SetRow(1, Matrix<double, 1, 3>{1, 1e-12, 0});
+    REQUIRE(incremental.UpdatesSinceRefactorization() == 0);
+    incremental.SetRow(1, Matrix<double, 1, 3>{0, 2, 0});
+    CheckIncrementalInverse(incremental);
+    REQUIRE(incremental.GetDeterminant() == Approx(2));
+  }
+
+  {
+    // fl(49 * fl(1 / 49)) < 1, so the capacitance matrix of this singular update is tiny but nonzero and, with no
+    // tolerance for its conditioning, only the residual check rejects the Woodbury result
+    IncrementalInverse<double, 2> incremental(Matrix<double, 2, 2>{49, 0, 0, 1}, 0);
+    REQUIRE_THROWS_AS(incremental.UpdateRank1(Matrix<double, 2, 1>{-49, 0}, Matrix<double, 1, 2>{1, 0}), MatrixIsDegenerateError);  // NOLINT
+    REQUIRE(incremental.GetMatrix() == Matrix<double, 2, 2>{49, 0, 0, 1});
+    REQUIRE(incremental.GetDeterminant() == 49);
+    CheckIncrementalInverse(incremental);
+  }
+
+  const Matrix<double, 2, 2> singular{1, 2, 2, 4};
+  using SmallIncrementalInverse = IncrementalInverse<double, 2>;
+  REQUIRE_THROWS_AS(SmallIncrementalInverse{singular}, MatrixIsDegenerateError);  // NOLINT
+}
+
+TEST_CASE("LeastSquares", "[Public]") {
+  {
+    const Matrix<double, 5, 3> a{1, 2, 0, -1, 3, 1, 2, 0, 4, 0, 1, -2, 3, -1, 1};
+    const Matrix<double, 5, 2> b{1, 0, 2, -1, 0, 3, 1, 1, -2, 4};
+    const QrDecomposition<double, 5, 3> qr(a);
+    const auto q = qr.GetQ();
+    const auto r = qr.GetR();
+    const auto product = q * r;
+    const auto gram = GetTransposed(q) * q;
+    for (size_t i = 0; i < 5; i++) {
+      for (size_t j = 0; j < 3; j++) {
+        REQUIRE(product(i, j) == Approx(a(i, j)).margin(1e-12));
+      }
+    }
+    for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 3; j++) {
+        REQUIRE(gram(i, j) == Approx(i == j ? 1 : 0).margin(1e-12));
+        if (i > j) {
+          REQUIRE(r(i, j) == 0);
+        }
+      }
+    }
+    const auto x = LeastSquares(a, b);
+    const auto normal = GetInversed(GetTransposed(a) * a) * (GetTransposed(a) * b);
+    for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 2; j++) {
+        REQUIRE(x(i, j) == Approx(normal(i, j)));
+      }
+    }
+    const auto column = qr.Solve(Matrix<double, 5, 1>{0, -1, 3, 1, 4});
+    REQUIRE(column(0, 0) == Approx(x(0, 1)));
+  }
+
+  {
+    Matrix<double, 90, 40> a{};
+    Matrix<double, 40, 1> solution{};
+    for (size_t i = 0; i < 90; i++) {
+      for (size_t j = 0; j < 40; j++) {
+        a(i, j) = std::sin(static_cast<double>(i * 40 + j)) + (i == j ? 4 : 0);
+      }
+    }
+    for (size_t j = 0; j < 40; j++) {
+      solution(j, 0) = static_cast<double>(j % 5) - 2;
+    }
+    const auto x = LeastSquares(a, a * solution);
+    for (size_t j = 0; j < 40; j++) {
+      REQUIRE(x(j, 0) == Approx(solution(j, 0)).margin(1e-9));
+    }
+    const QrDecomposition<double, 90, 40> qr(ToLayout<MatrixLayout::kColumnMajor>(a));
+    const auto product = qr.GetQ() * qr.GetR();
+    double error = 0;
+    for (size_t i = 0; i < 90; i++) {
+      for (size_t j = 0; j < 40; j++) {
+        error = std::max(error, std::abs(product(i, j) - a(i, j)));
+      }
+    }
+    REQUIRE(error < 1e-10);
+  }
+
+  {
+    const Matrix<double, 3, 2> a{1, 0, 2, 0, 3, 0};
+    REQUIRE_THROWS_AS(LeastSquares(a, Matrix<double, 3, 1>{1, 2, 3}), MatrixIsDegenerateError);  // NOLINT
+  }
+}
@@ -0,0 +1,204 @@
+#ifndef QR_H_
+#define QR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+
+#include "matrix.h"
+
+// Number of Householder reflectors that are accumulated into one block reflector I - V T V^T.
+constexpr size_t kHouseholderBlockSize = 32;
+
+// A = Q R with Q = H_1 H_2 ... H_M a product of Householder reflectors H_j = I - tau_j v_j v_j^T. R is kept in the
+// upper triangle of the factors and the essential parts of v_j (v_j(j) = 1) below it, as in LAPACK. Columns are
+// factorized in panels of kHouseholderBlockSize; the panel's reflectors are combined into a block reflector which is
+// applied to the rest of the matrix (and later to right-hand sides) with the blocked product kernel.
+template <class T, size_t N, size_t M>
+class QrDecomposition {
+  static_assert(N >= M, "QR decomposition requires at least as many rows as columns");
+  static_assert(std::is_floating_point_v<T>, "QR decomposition requires a floating point matrix");
+
+ public:
+  template <MatrixLayout Layout>
+  explicit QrDecomposition(const Matrix<T, N, M, Layout>& matrix)
+      : factors_{std::make_unique<T[]>(N * M)}
+      , tau_{std::make_unique<T[]>(M)}
+      , triangular_{std::make_unique<T[]>(M * kHouseholderBlockSize)} {
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < M; j++) {
+        factors_[i * M + j] = matrix(i, j);
+      }
+    }
+    for (size_t k = 0; k < M; k += kHouseholderBlockSize) {
+      size_t size = std::min(kHouseholderBlockSize, M - k);
+      FactorizePanel(k, size);
+      FormTriangular(k, size);
+      if (k + size < M) {
+        ApplyBlock(k, size, true, factors_.get() + k + size, M, M - k - size);
+      }
+    }
+  }
+
+  Matrix<T, M, M> GetR() const {
+    Matrix<T, M, M> result{};
+    for (size_t i = 0; i < M; i++) {
+      for (size_t j = i; j < M; j++) {
+        result(i, j) = factors_[i * M + j];
+      }
+    }
+    return result;
+  }
+
+  // The first M columns of Q.
+  Matrix<T, N, M> GetQ() const {
+    auto columns = std::make_unique<T[]>(N * M);
+    for (size_t i = 0; i < M; i++) {
+      columns[i * M + i] = 1;
+    }
+    for (size_t k = (M - 1) / kHouseholderBlockSize * kHouseholderBlockSize;; k -= kHouseholderBlockSize) {
+      ApplyBlock(k, std::min(kHouseholderBlockSize, M - k), false, columns.get(), M, M);
+      if (k == 0) {
+        break;
+      }
+    }
+    Matrix<T, N, M> result;
+    std::copy_n(columns.get(), N * M, &result.matrix[0][0]);
+    return result;
+  }
+
+  // Least squares solution of A x = b for every column of b: R x = (Q^T b)[0, M).
+  template <size_t K, MatrixLayout Layout>
+  Matrix<T, M, K> Solve(const Matrix<T, N, K, Layout>& b) const {
+    auto rhs = std::make_unique<T[]>(N * K);
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < K; j++) {
+        rhs[i * K + j] = b(i, j);
+      }
+    }
+    for (size_t k = 0; k < M; k += kHouseholderBlockSize) {
+      ApplyBlock(k, std::min(kHouseholderBlockSize, M - k), true, rhs.get(), K, K);
+    }
+    Matrix<T, M, K> result;
+    for (size_t i = M; i-- > 0;) {
+      const T& diagonal = factors_[i * M + i];
+      if (diagonal == 0) {
+        throw MatrixIsDegenerateError{};
+      }
+      for (size_t j = 0; j < K; j++) {
+        T value = rhs[i * K + j];
+        for (size_t l = i + 1; l < M; l++) {
+          value -= factors_[i * M + l] * result(l, j);
+        }
+        result(i, j) = value / diagonal;
+      }
+    }
+    return result;
+  }
+
+ private:
+  std::unique_ptr<T[]> factors_;
+  std::unique_ptr<T[]> tau_;
+  // The size x size upper triangular T of the block starting at column k, with leading dimension
+  // kHouseholderBlockSize, at offset k * kHouseholderBlockSize.
+  std::unique_ptr<T[]> triangular_;
+
+  T GetReflector(size_t row, size_t column) const {
+    return row > column ? factors_[row * M + column] : row == column ? 1 : 0;
+  }
+
+  // Unblocked Householder factorization of columns [k, k + size), updating only these columns.
+  void FactorizePanel(size_t k, size_t size) {
+    for (size_t j = k; j < k + size; j++) {
+      T sigma = 0;
+      for (size_t i = j + 1; i < N; i++) {
+        sigma += factors_[i * M + j] * factors_[i * M + j];
+      }
+      const T alpha = factors_[j * M + j];
+      if (sigma == 0) {
+        tau_[j] = 0;
+        continue;
+      }
+      const T norm = std::sqrt(alpha * alpha + sigma);
+      const T beta = alpha > 0 ? -norm : norm;
+      tau_[j] = (beta - alpha) / beta;
+      const T scale = 1 / (alpha - beta);
+      for (size_t i = j + 1; i < N; i++) {
+        factors_[i * M + j] *= scale;
+      }
+      factors_[j * M + j] = beta;
+      for (size_t c = j + 1; c < k + size; c++) {
+        T dot = factors_[j * M + c];
+        for (size_t i = j + 1; i < N; i++) {
+          dot += factors_[i * M + j] * factors_[i * M + c];
+        }
+        dot *= tau_[j];
+        factors_[j * M + c] -= dot;
+        for (size_t i = j + 1; i < N; i++) {
+          factors_[i * M + c] -= dot * factors_[i * M + j];
+        }
+      }
+    }
+  }
+
+  // H_k ... H_{k + size - 1} = I - V T V^T with T upper triangular (the forward, column-wise scheme of LAPACK).
+  void FormTriangular(size_t k, size_t size) {
+    T* t = triangular_.get() + k * kHouseholderBlockSize;
+    for (size_t i = 0; i < size; i++) {
+      const T tau = tau_[k + i];
+      for (size_t j = 0; j < i; j++) {
+        T dot = 0;
+        for (size_t r = k + i; r < N; r++) {
+          dot += GetReflector(r, k + j) * GetReflector(r, k + i);
+        }
+        t[j * kHouseholderBlockSize + i] = -tau * dot;
+      }
+      for (size_t j = 0; j < i; j++) {
+        T value = 0;
+        for (size_t l = j; l < i; l++) {
+          value += t[j * kHouseholderBlockSize + l] * t[l * kHouseholderBlockSize + i];
+        }
+        t[j * kHouseholderBlockSize + i] = value;
+      }
+      t[i * kHouseholderBlockSize + i] = tau;
+    }
+  }
+
+  // c = (I - V T' V^T) c on rows [k, N) of the N x columns matrix c, with T' = T^T if transposed (applying Q^T) and
+  // T' = T otherwise (applying Q).
+  void ApplyBlock(size_t k, size_t size, bool transposed, T* c, size_t ldc, size_t columns) const {
+    const size_t rows = N - k;
+    auto v = std::make_unique<T[]>(rows * size);
+    auto vt = std::make_unique<T[]>(size * rows);
+    for (size_t i = 0; i < rows; i++) {
+      for (size_t j = 0; j < size; j++) {
+        v[i * size + j] = vt[j * rows + i] = GetReflector(k + i, k + j);
+      }
+    }
+    auto t = std::make_unique<T[]>(size * size);
+    const T* block = triangular_.get() + k * kHouseholderBlockSize;
+    for (size_t i = 0; i < size; i++) {
+      for (size_t j = i; j < size; j++) {
+        (transposed ? t[j * size + i] : t[i * size + j]) = block[i * kHouseholderBlockSize + j];
+      }
+    }
+    auto w = std::make_unique<T[]>(size * columns);
+    auto tw = std::make_unique<T[]>(size * columns);
+    MultiplyAddBlocked(size, rows, columns, vt.get(), rows, c + k * ldc, ldc, w.get(), columns);
+    MultiplyAddBlocked(size, size, columns, t.get(), size, w.get(), columns, tw.get(), columns);
+    for (size_t i = 0; i < size * columns; i++) {
+      tw[i] = -tw[i];
+    }
+    MultiplyAddBlocked(rows, size, columns, v.get(), size, tw.get(), columns, c + k * ldc, ldc);
+  }
+};
+
+// Solves min |A x - b| for every column of b through the QR decomposition of A, without forming A^T A. Use
+// QrDecomposition directly to reuse the factorization for several right-hand sides.
+template <class T, size_t N, size_t M, size_t K, MatrixLayout LayoutA, MatrixLayout LayoutB>
+Matrix<T, M, K> LeastSquares(const Matrix<T, N, M, LayoutA>& a, const Matrix<T, N, K, LayoutB>& b) {
+  return QrDecomposition<T, N, M>(a).Solve(b);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef RATIONAL_MATRIX_H_
+#define RATIONAL_MATRIX_H_
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "../rational/rational.h"
+#include "matrix.h"
+
+// Brings every row of the left operand and every column of the right one to a common denominator, so that each
+// output element is a sum of integer products over a single denominator and is reduced only once. Elements whose
+// intermediate values do not fit into 128 bits are computed with plain Rational arithmetic. rational.h declares this
+// specialization, so that no translation unit can multiply Matrix<Rational> with the generic kernel instead.
+template <>
+struct MatrixMultiplier<Rational> {
+  using Wide = __int128;
+  using UnsignedWide = unsigned __int128;
+
+  template <size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC>
+  static void Multiply(MatrixView<Rational, N, M, LayoutA> a, MatrixView<Rational, M, L, LayoutB> b, Matrix<Rational, N, L, LayoutC>& result) {
+    auto a_numerators = std::make_unique<Wide[]>(N * M);
+    auto a_denominators = std::make_unique<Wide[]>(N);
+    auto a_bits = std::make_unique<int[]>(N);
+    for (size_t i = 0; i < N; i++) {
+      a_denominators[i] = Scale([&](size_t k) -> const Rational& { return a(i, k); }, M, a_numerators.get() + i * M, a_bits[i]);
+    }
+    auto b_numerators = std::make_unique<Wide[]>(L * M);
+    auto b_denominators = std::make_unique<Wide[]>(L);
+    auto b_bits = std::make_unique<int[]>(L);
+    for (size_t j = 0; j < L; j++) {
+      b_denominators[j] = Scale([&](size_t k) -> const Rational& { return b(k, j); }, M, b_numerators.get() + j * M, b_bits[j]);
+    }
+    const int depth_bits = BitWidth(M);
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < L; j++) {
+        if (a_denominators[i] != 0 && b_denominators[j] != 0) {
+          const Wide* p = a_numerators.get() + i * M;
+          const Wide* q = b_numerators.get() + j * M;
+          Wide sum = 0;
+          bool overflow = false;
+          if (a_bits[i] + b_bits[j] + depth_bits < 127) {
+            for (size_t k = 0; k < M; k++) {
+              sum += p[k] * q[k];
+            }
+          } else {
+            for (size_t k = 0; k < M && !overflow; k++) {
+              Wide product;
+              overflow = __builtin_mul_overflow(p[k], q[k], &product) || __builtin_add_overflow(sum, product, &sum);
+            }
+          }
+          if (!overflow && Store(sum, a_denominators[i] * b_denominators[j], result(i, j))) {
+            continue;
+          }
+        }
+        result(i, j) = Rational{};
+        for (size_t k = 0; k < M; k++) {
+          result(i, j) += a(i, k) * b(k, j);
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr Wide kMax = std::numeric_limits<int64_t>::max();
+  static constexpr Wide kMin = std::numeric_limits<int64_t>::min();
+
+  static UnsignedWide Abs(Wide value) {
+    return value < 0 ? -static_cast<UnsignedWide>(value) : static_cast<UnsignedWide>(value);
+  }
+
+  static UnsignedWide Gcd(UnsignedWide a, UnsignedWide b) {
+    while (b != 0) {
+      a %= b;
+      std::swap(a, b);
+    }
+    return a;
+  }
+
+  static int BitWidth(UnsignedWide value) {
+    int bits = 0;
+    for (; value != 0; value >>= 1) {
+      bits++;
+    }
+    return bits;
+  }
+
+  // Returns the common denominator of count values and writes their numerators scaled to it, or returns 0 if the
+  // denominator does not fit into int64_t.
+  template <class Getter>
+  static Wide Scale(Getter get, size_t count, Wide* numerators, int& bits) {
+    Wide denominator = 1;
+    for (size_t k = 0; k < count; k++) {
+      Wide value = get(k).GetDenominator();
+      denominator = denominator / static_cast<Wide>(Gcd(denominator, value)) * value;
+      if (denominator > kMax) {
+        return 0;
+      }
+    }
+    UnsignedWide magnitude = 0;
+    for (size_t k = 0; k < count; k++) {
+      numerators[k] = get(k).GetNumerator() * (denominator / get(k).GetDenominator());
+      magnitude |= Abs(numerators[k]);
+    }
+    bits = BitWidth(magnitude);
+    return denominator;
+  }
+
+  static bool Store(Wide numerator, Wide denominator, Rational& result) {
+    if (numerator == 0) {
+      result = Rational{};
+      return true;
+    }
+    auto factor = static_cast<Wide>(Gcd(Abs(numerator), denominator));
+    numerator /= factor;
+    denominator /= factor;
+    if (numerator < kMin || numerator > kMax || denominator > kMax) {
+      return false;
+    }
+    result = Rational(static_cast<int64_t>(numerator), static_cast<int64_t>(denominator));
+    return true;
+  }
+};
+
+#endif
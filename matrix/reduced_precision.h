@@ -0,0 +1,430 @@
+#ifndef REDUCED_PRECISION_H_
+#define REDUCED_PRECISION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#include "matrix.h"
+
+inline uint32_t GetFloatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float GetFloatFromBits(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// IEEE 754 binary16 conversions with round-to-nearest-even, including subnormals, infinities and NaN.
+inline uint16_t FloatToHalfBits(float value) {
+#ifdef __F16C__
+  return _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+#else
+  uint32_t bits = GetFloatBits(value);
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t exponent = (bits >> 23) & 0xFF;
+  uint32_t mantissa = bits & 0x7FFFFF;
+  if (exponent == 0xFF) {
+    return sign | 0x7C00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0);
+  }
+  int32_t half_exponent = static_cast<int32_t>(exponent) - 127 + 15;
+  if (half_exponent >= 31) {
+    return sign | 0x7C00;
+  }
+  if (half_exponent <= 0) {
+    if (half_exponent < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    uint32_t shift = 14 - half_exponent;
+    uint32_t half = mantissa >> shift;
+    uint32_t remainder = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+      half++;
+    }
+    return sign | half;
+  }
+  uint32_t half = (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+  uint32_t remainder = mantissa & 0x1FFF;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+    half++;  // a carry into the exponent is the correct rounding, up to infinity
+  }
+  return sign | half;
+#endif
+}
+
+inline float HalfBitsToFloat(uint16_t half) {
+#ifdef __F16C__
+  return _cvtsh_ss(half);
+#else
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1F;
+  uint32_t mantissa = half & 0x3FF;
+  if (exponent == 0x1F) {
+    return GetFloatFromBits(sign | 0x7F800000 | (mantissa << 13));
+  }
+  if (exponent != 0) {
+    return GetFloatFromBits(sign | ((exponent + 112) << 23) | (mantissa << 13));
+  }
+  if (mantissa == 0) {
+    return GetFloatFromBits(sign);
+  }
+  exponent = 113;
+  while ((mantissa & 0x400) == 0) {
+    mantissa <<= 1;
+    exponent--;
+  }
+  return GetFloatFromBits(sign | (exponent << 23) | ((mantissa & 0x3FF) << 13));
+#endif
+}
+
+inline uint16_t FloatToBFloat16Bits(float value) {
+  uint32_t bits = GetFloatBits(value);
+  if (std::isnan(value)) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+inline float BFloat16BitsToFloat(uint16_t bfloat) {
+  return GetFloatFromBits(static_cast<uint32_t>(bfloat) << 16);
+}
+
+// Storage-only 16-bit floating point types: arithmetic is done in float and rounded back on assignment.
+class Half {
+ public:
+  Half() = default;
+
+  Half(float value) : bits_{FloatToHalfBits(value)} {  // NOLINT
+  }
+
+  operator float() const {  // NOLINT
+    return HalfBitsToFloat(bits_);
+  }
+
+  static Half FromBits(uint16_t bits) {
+    Half result;
+    result.bits_ = bits;
+    return result;
+  }
+
+  uint16_t GetBits() const {
+    return bits_;
+  }
+
+  Half& operator+=(float other) {
+    return *this = static_cast<float>(*this) + other;
+  }
+
+  Half& operator-=(float other) {
+    return *this = static_cast<float>(*this) - other;
+  }
+
+  Half& operator*=(float other) {
+    return *this = static_cast<float>(*this) * other;
+  }
+
+  Half& operator/=(float other) {
+    return *this = static_cast<float>(*this) / other;
+  }
+
+ private:
+  uint16_t bits_;
+};
+
+class BFloat16 {
+ public:
+  BFloat16() = default;
+
+  BFloat16(float value) : bits_{FloatToBFloat16Bits(value)} {  // NOLINT
+  }
+
+  operator float() const {  // NOLINT
+    return BFloat16BitsToFloat(bits_);
+  }
+
+  static BFloat16 FromBits(uint16_t bits) {
+    BFloat16 result;
+    result.bits_ = bits;
+    return result;
+  }
+
+  uint16_t GetBits() const {
+    return bits_;
+  }
+
+  BFloat16& operator+=(float other) {
+    return *this = static_cast<float>(*this) + other;
+  }
+
+  BFloat16& operator-=(float other) {
+    return *this = static_cast<float>(*this) - other;
+  }
+
+  BFloat16& operator*=(float other) {
+    return *this = static_cast<float>(*this) * other;
+  }
+
+  BFloat16& operator/=(float other) {
+    return *this = static_cast<float>(*this) / other;
+  }
+
+ private:
+  uint16_t bits_;
+};
+
+template <>
+struct MatrixElementKind<Half> {
+  static constexpr const char* kName = "half";
+};
+
+template <>
+struct MatrixElementKind<BFloat16> {
+  static constexpr const char* kName = "bfloat16";
+};
+
+inline std::istream& operator>>(std::istream& in, Half& value) {
+  float input;
+  if (in >> input) {
+    value = input;
+  }
+  return in;
+}
+
+inline std::istream& operator>>(std::istream& in, BFloat16& value) {
+  float input;
+  if (in >> input) {
+    value = input;
+  }
+  return in;
+}
+
+// Type in which products of T are accumulated.
+template <class T>
+struct MatrixAccumulator {
+  using Type = T;
+};
+
+template <>
+struct MatrixAccumulator<Half> {
+  using Type = float;
+};
+
+template <>
+struct MatrixAccumulator<BFloat16> {
+  using Type = float;
+};
+
+template <>
+struct MatrixAccumulator<int8_t> {
+  using Type = int32_t;
+};
+
+template <>
+struct MatrixAccumulator<uint8_t> {
+  using Type = uint32_t;
+};
+
+template <class U, class T, size_t N, size_t M, MatrixLayout Layout>
+void MatrixCastInto(const Matrix<T, N, M, Layout>& matrix, Matrix<U, N, M, Layout>& result) {
+  for (size_t i = 0; i < matrix.kStorageRows; i++) {
+    for (size_t j = 0; j < matrix.kStorageColumns; j++) {
+      result.matrix[i][j] = static_cast<U>(matrix.matrix[i][j]);
+    }
+  }
+}
+
+template <class U, class T, size_t N, size_t M, MatrixLayout Layout>
+Matrix<U, N, M, Layout> MatrixCast(const Matrix<T, N, M, Layout>& matrix) {
+  Matrix<U, N, M, Layout> result;
+  MatrixCastInto(matrix, result);
+  return result;
+}
+
+// Element (i, j) of a matrix is stored at data[i * row + j * column], which describes both layouts.
+struct MatrixStrides {
+  size_t row;
+  size_t column;
+};
+
+template <size_t N, size_t M, MatrixLayout Layout>
+constexpr MatrixStrides GetMatrixStrides() {
+  return Layout == MatrixLayout::kRowMajor ? MatrixStrides{M, 1} : MatrixStrides{1, N};
+}
+
+// Copies the rows x columns block of from at (row, column) into the row-major buffer to, converting to W and reading
+// in storage order.
+template <class W, class T>
+void LoadMatrixBlock(const T* from, MatrixStrides strides, size_t row, size_t column, size_t rows, size_t columns, W* to) {
+  const T* block = from + row * strides.row + column * strides.column;
+  if (strides.column == 1) {
+    for (size_t i = 0; i < rows; i++) {
+      for (size_t j = 0; j < columns; j++) {
+        to[i * columns + j] = static_cast<W>(block[i * strides.row + j]);
+      }
+    }
+  } else {
+    for (size_t j = 0; j < columns; j++) {
+      for (size_t i = 0; i < rows; i++) {
+        to[i * columns + j] = static_cast<W>(block[i + j * strides.column]);
+      }
+    }
+  }
+}
+
+template <class W, class T>
+void StoreMatrixBlock(const W* from, size_t rows, size_t columns, T* to, MatrixStrides strides, size_t row, size_t column) {
+  T* block = to + row * strides.row + column * strides.column;
+  if (strides.column == 1) {
+    for (size_t i = 0; i < rows; i++) {
+      for (size_t j = 0; j < columns; j++) {
+        block[i * strides.row + j] = static_cast<T>(from[i * columns + j]);
+      }
+    }
+  } else {
+    for (size_t j = 0; j < columns; j++) {
+      for (size_t i = 0; i < rows; i++) {
+        block[i + j * strides.column] = static_cast<T>(from[i * columns + j]);
+      }
+    }
+  }
+}
+
+// c (n x l) += a (n x m) * b (m x l) for storage-only T such as Half, computed in W. Only one tile of each operand is
+// widened at a time, into a per-thread buffer sized from GetMatrixTileSizes<T>(): every rows x columns block of c is
+// accumulated in W over the whole depth from rows x depth panels of a and depth x columns panels of b, then stored
+// back, so that c is rounded once per element and the operands are read in their narrow form.
+template <class W, class T, class C>
+void MultiplyAddWidenedBlocked(size_t n, size_t m, size_t l, const T* a, MatrixStrides a_strides, const T* b, MatrixStrides b_strides, C* c, MatrixStrides c_strides) {
+  const MatrixTileSizes tiles = GetMatrixTileSizes<T>();
+  const size_t rows = std::min(n, tiles.rows);
+  const size_t depth = std::min(m, tiles.depth);
+  const size_t columns = std::min(l, tiles.columns);
+  thread_local std::vector<W> buffer;
+  buffer.resize(rows * depth + depth * columns + rows * columns);
+  W* a_panel = buffer.data();
+  W* b_panel = a_panel + rows * depth;
+  W* c_block = b_panel + depth * columns;
+  for (size_t ii = 0; ii < n; ii += rows) {
+    const size_t i_count = std::min(rows, n - ii);
+    for (size_t jj = 0; jj < l; jj += columns) {
+      const size_t j_count = std::min(columns, l - jj);
+      LoadMatrixBlock(c, c_strides, ii, jj, i_count, j_count, c_block);
+      for (size_t kk = 0; kk < m; kk += depth) {
+        const size_t k_count = std::min(depth, m - kk);
+        LoadMatrixBlock(a, a_strides, ii, kk, i_count, k_count, a_panel);
+        LoadMatrixBlock(b, b_strides, kk, jj, k_count, j_count, b_panel);
+        for (size_t i = 0; i < i_count; i++) {
+          W* c_row = c_block + i * j_count;
+          for (size_t k = 0; k < k_count; k++) {
+            const W a_value = a_panel[i * k_count + k];
+            const W* b_row = b_panel + k * j_count;
+            for (size_t j = 0; j < j_count; j++) {
+              c_row[j] += a_value * b_row[j];
+            }
+          }
+        }
+      }
+      StoreMatrixBlock(c_block, i_count, j_count, c, c_strides, ii, jj);
+    }
+  }
+}
+
+// c += a * b with T elements accumulated in U. Built-in narrow types convert for free inside the layout-specific
+// kernels; class types such as Half and BFloat16 go through MultiplyAddWidenedBlocked.
+template <class T, class U, size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC>
+void MultiplyAddWidened(const Matrix<T, N, M, LayoutA>& a, const Matrix<T, M, L, LayoutB>& b, Matrix<U, N, L, LayoutC>& c) {
+  if constexpr (std::is_arithmetic_v<T>) {
+    MultiplyAddMatrices(MatrixView(a), MatrixView(b), c);
+  } else {
+    MultiplyAddWidenedBlocked<U>(N, M, L, &a.matrix[0][0], GetMatrixStrides<N, M, LayoutA>(), &b.matrix[0][0], GetMatrixStrides<M, L, LayoutB>(), &c.matrix[0][0], GetMatrixStrides<N, L, LayoutC>());
+  }
+}
+
+// Product of narrow matrices, accumulated and returned in the wide type.
+template <class T, size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB>
+Matrix<typename MatrixAccumulator<T>::Type, N, L, LayoutA> MultiplyWide(const Matrix<T, N, M, LayoutA>& a, const Matrix<T, M, L, LayoutB>& b) {
+  Matrix<typename MatrixAccumulator<T>::Type, N, L, LayoutA> result{};
+  MultiplyAddWidened(a, b, result);
+  return result;
+}
+
+// Accumulates in float and rounds every element once, instead of rounding after every multiply-add.
+template <class T>
+struct ReducedPrecisionMultiplier {
+  template <size_t N, size_t M, size_t L, MatrixLayout LayoutA, MatrixLayout LayoutB, MatrixLayout LayoutC>
+  static void Multiply(MatrixView<T, N, M, LayoutA> a, MatrixView<T, M, L, LayoutB> b, Matrix<T, N, L, LayoutC>& result) {
+    MultiplyAddWidenedBlocked<float>(N, M, L, a.Data(), GetMatrixStrides<N, M, LayoutA>(), b.Data(), GetMatrixStrides<M, L, LayoutB>(), &result.matrix[0][0], GetMatrixStrides<N, L, LayoutC>());
+  }
+};
+
+template <>
+struct MatrixMultiplier<Half> : ReducedPrecisionMultiplier<Half> {};
+
+template <>
+struct MatrixMultiplier<BFloat16> : ReducedPrecisionMultiplier<BFloat16> {};
+
+// int8 values with one float scale for the whole matrix: element (i, j) stands for values(i, j) * scale.
+template <size_t N, size_t M>
+struct QuantizedMatrix {
+  Matrix<int8_t, N, M> values;
+  float scale;
+};
+
+// Symmetric quantization: the largest magnitude maps to 127.
+template <size_t N, size_t M>
+QuantizedMatrix<N, M> Quantize(const Matrix<float, N, M>& matrix) {
+  float largest = 0;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      largest = std::max(largest, std::abs(matrix(i, j)));
+    }
+  }
+  QuantizedMatrix<N, M> result;
+  result.scale = largest > 0 ? largest / 127 : 1;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      result.values(i, j) = static_cast<int8_t>(std::clamp(std::lround(matrix(i, j) / result.scale), -127l, 127l));
+    }
+  }
+  return result;
+}
+
+template <size_t N, size_t M>
+Matrix<float, N, M> Dequantize(const QuantizedMatrix<N, M>& matrix) {
+  Matrix<float, N, M> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) = matrix.values(i, j) * matrix.scale;
+    }
+  }
+  return result;
+}
+
+template <size_t N, size_t M, size_t L>
+Matrix<float, N, L> operator*(const QuantizedMatrix<N, M>& a, const QuantizedMatrix<M, L>& b) {
+  auto wide = MultiplyWide(a.values, b.values);
+  Matrix<float, N, L> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < L; j++) {
+      result(i, j) = static_cast<float>(wide(i, j)) * (a.scale * b.scale);
+    }
+  }
+  return result;
+}
+
+#endif
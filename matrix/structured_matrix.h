@@ -0,0 +1,481 @@
+#ifndef STRUCTURED_MATRIX_H_
+#define STRUCTURED_MATRIX_H_
+
+#include <algorithm>
+#include <utility>
+
+#include "matrix.h"
+
+template <class T, size_t N>
+class DiagonalMatrix {
+ public:
+  T diagonal[N];
+
+  T operator()(size_t i, size_t j) const {
+    return i == j ? diagonal[i] : T{};
+  }
+
+  T& At(size_t i, size_t j) {
+    if (i >= N || j >= N || i != j) {
+      throw MatrixOutOfRange{};
+    }
+    return diagonal[i];
+  }
+
+  T At(size_t i, size_t j) const {
+    if (i >= N || j >= N) {
+      throw MatrixOutOfRange{};
+    }
+    return operator()(i, j);
+  }
+};
+
+// Only the lower triangle is stored, packed row by row; (i, j) and (j, i) refer to the same element.
+template <class T, size_t N>
+class SymmetricMatrix {
+ public:
+  T packed[N * (N + 1) / 2];
+
+  static size_t Index(size_t i, size_t j) {
+    return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+  }
+
+  T& operator()(size_t i, size_t j) {
+    return packed[Index(i, j)];
+  }
+
+  const T& operator()(size_t i, size_t j) const {
+    return packed[Index(i, j)];
+  }
+
+  T& At(size_t i, size_t j) {
+    if (i >= N || j >= N) {
+      throw MatrixOutOfRange{};
+    }
+    return packed[Index(i, j)];
+  }
+
+  const T& At(size_t i, size_t j) const {
+    if (i >= N || j >= N) {
+      throw MatrixOutOfRange{};
+    }
+    return packed[Index(i, j)];
+  }
+};
+
+enum class Triangle {
+  kUpper,
+  kLower,
+};
+
+// The upper triangle is packed by rows and the lower one by columns, so a triangular matrix and its transpose have
+// identical storage. Elements outside the triangle read as zero; the non-const operator() may only be used inside it.
+template <class T, size_t N, Triangle Kind>
+class TriangularMatrix {
+ public:
+  T packed[N * (N + 1) / 2];
+
+  static bool IsStored(size_t i, size_t j) {
+    return Kind == Triangle::kUpper ? i <= j : i >= j;
+  }
+
+  static size_t Index(size_t i, size_t j) {
+    if (Kind == Triangle::kLower) {
+      std::swap(i, j);
+    }
+    return i * (2 * N - i + 1) / 2 + (j - i);
+  }
+
+  T& operator()(size_t i, size_t j) {
+    return packed[Index(i, j)];
+  }
+
+  T operator()(size_t i, size_t j) const {
+    return IsStored(i, j) ? packed[Index(i, j)] : T{};
+  }
+
+  T& At(size_t i, size_t j) {
+    if (i >= N || j >= N || !IsStored(i, j)) {
+      throw MatrixOutOfRange{};
+    }
+    return packed[Index(i, j)];
+  }
+
+  T At(size_t i, size_t j) const {
+    if (i >= N || j >= N) {
+      throw MatrixOutOfRange{};
+    }
+    return operator()(i, j);
+  }
+};
+
+template <class T, size_t N>
+using UpperTriangularMatrix = TriangularMatrix<T, N, Triangle::kUpper>;
+
+template <class T, size_t N>
+using LowerTriangularMatrix = TriangularMatrix<T, N, Triangle::kLower>;
+
+// Row i stores the elements (i, i - Lower) ... (i, i + Upper); slots that fall outside the matrix are unused.
+template <class T, size_t N, size_t Lower, size_t Upper>
+class BandedMatrix {
+ public:
+  T band[N][Lower + Upper + 1];
+
+  static bool IsStored(size_t i, size_t j) {
+    return j + Lower >= i && j <= i + Upper;
+  }
+
+  T& operator()(size_t i, size_t j) {
+    return band[i][j + Lower - i];
+  }
+
+  T operator()(size_t i, size_t j) const {
+    return IsStored(i, j) ? band[i][j + Lower - i] : T{};
+  }
+
+  T& At(size_t i, size_t j) {
+    if (i >= N || j >= N || !IsStored(i, j)) {
+      throw MatrixOutOfRange{};
+    }
+    return band[i][j + Lower - i];
+  }
+
+  T At(size_t i, size_t j) const {
+    if (i >= N || j >= N) {
+      throw MatrixOutOfRange{};
+    }
+    return operator()(i, j);
+  }
+
+  size_t GetBegin(size_t i) const {
+    return i > Lower ? i - Lower : 0;
+  }
+
+  size_t GetEnd(size_t i) const {
+    return std::min(N, i + Upper + 1);
+  }
+};
+
+template <class Structured, class T, size_t N>
+Matrix<T, N, N> ToMatrixImpl(const Structured& structured) {
+  Matrix<T, N, N> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < N; j++) {
+      result(i, j) = structured(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N>
+Matrix<T, N, N> ToMatrix(const DiagonalMatrix<T, N>& matrix) {
+  return ToMatrixImpl<DiagonalMatrix<T, N>, T, N>(matrix);
+}
+
+template <class T, size_t N>
+Matrix<T, N, N> ToMatrix(const SymmetricMatrix<T, N>& matrix) {
+  return ToMatrixImpl<SymmetricMatrix<T, N>, T, N>(matrix);
+}
+
+template <class T, size_t N, Triangle Kind>
+Matrix<T, N, N> ToMatrix(const TriangularMatrix<T, N, Kind>& matrix) {
+  return ToMatrixImpl<TriangularMatrix<T, N, Kind>, T, N>(matrix);
+}
+
+template <class T, size_t N, size_t Lower, size_t Upper>
+Matrix<T, N, N> ToMatrix(const BandedMatrix<T, N, Lower, Upper>& matrix) {
+  return ToMatrixImpl<BandedMatrix<T, N, Lower, Upper>, T, N>(matrix);
+}
+
+template <class T, size_t N>
+DiagonalMatrix<T, N> ToDiagonal(const Matrix<T, N, N>& matrix) {
+  DiagonalMatrix<T, N> result;
+  for (size_t i = 0; i < N; i++) {
+    result.diagonal[i] = matrix(i, i);
+  }
+  return result;
+}
+
+// Takes the lower triangle of matrix.
+template <class T, size_t N>
+SymmetricMatrix<T, N> ToSymmetric(const Matrix<T, N, N>& matrix) {
+  SymmetricMatrix<T, N> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j <= i; j++) {
+      result(i, j) = matrix(i, j);
+    }
+  }
+  return result;
+}
+
+template <Triangle Kind, class T, size_t N>
+TriangularMatrix<T, N, Kind> ToTriangular(const Matrix<T, N, N>& matrix) {
+  TriangularMatrix<T, N, Kind> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < N; j++) {
+      if (result.IsStored(i, j)) {
+        result(i, j) = matrix(i, j);
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N>
+UpperTriangularMatrix<T, N> ToUpperTriangular(const Matrix<T, N, N>& matrix) {
+  return ToTriangular<Triangle::kUpper>(matrix);
+}
+
+template <class T, size_t N>
+LowerTriangularMatrix<T, N> ToLowerTriangular(const Matrix<T, N, N>& matrix) {
+  return ToTriangular<Triangle::kLower>(matrix);
+}
+
+template <size_t Lower, size_t Upper, class T, size_t N>
+BandedMatrix<T, N, Lower, Upper> ToBanded(const Matrix<T, N, N>& matrix) {
+  BandedMatrix<T, N, Lower, Upper> result{};
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = result.GetBegin(i); j < result.GetEnd(i); j++) {
+      result(i, j) = matrix(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M>
+Matrix<T, N, M> operator*(const DiagonalMatrix<T, N>& a, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) = a.diagonal[i] * b(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M>
+Matrix<T, M, N> operator*(const Matrix<T, M, N>& a, const DiagonalMatrix<T, N>& b) {
+  Matrix<T, M, N> result;
+  for (size_t i = 0; i < M; i++) {
+    for (size_t j = 0; j < N; j++) {
+      result(i, j) = a(i, j) * b.diagonal[j];
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N>
+DiagonalMatrix<T, N> operator*(const DiagonalMatrix<T, N>& a, const DiagonalMatrix<T, N>& b) {
+  DiagonalMatrix<T, N> result;
+  for (size_t i = 0; i < N; i++) {
+    result.diagonal[i] = a.diagonal[i] * b.diagonal[i];
+  }
+  return result;
+}
+
+// Every off-diagonal element is read once and applied to both of the rows it belongs to.
+template <class T, size_t N, size_t M>
+Matrix<T, N, M> operator*(const SymmetricMatrix<T, N>& a, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result{};
+  for (size_t i = 0; i < N; i++) {
+    for (size_t k = 0; k < i; k++) {
+      const T& value = a(i, k);
+      for (size_t j = 0; j < M; j++) {
+        result(i, j) += value * b(k, j);
+        result(k, j) += value * b(i, j);
+      }
+    }
+    const T& value = a(i, i);
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) += value * b(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M>
+Matrix<T, M, N> operator*(const Matrix<T, M, N>& a, const SymmetricMatrix<T, N>& b) {
+  return GetTransposed(b * GetTransposed(a));
+}
+
+template <class T, size_t N, size_t M, Triangle Kind>
+Matrix<T, N, M> operator*(const TriangularMatrix<T, N, Kind>& a, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result{};
+  for (size_t i = 0; i < N; i++) {
+    size_t begin = Kind == Triangle::kUpper ? i : 0;
+    size_t end = Kind == Triangle::kUpper ? N : i + 1;
+    for (size_t k = begin; k < end; k++) {
+      const T& value = a.packed[a.Index(i, k)];
+      for (size_t j = 0; j < M; j++) {
+        result(i, j) += value * b(k, j);
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M, Triangle Kind>
+Matrix<T, M, N> operator*(const Matrix<T, M, N>& a, const TriangularMatrix<T, N, Kind>& b) {
+  Matrix<T, M, N> result{};
+  for (size_t i = 0; i < M; i++) {
+    for (size_t k = 0; k < N; k++) {
+      size_t begin = Kind == Triangle::kUpper ? k : 0;
+      size_t end = Kind == Triangle::kUpper ? N : k + 1;
+      for (size_t j = begin; j < end; j++) {
+        result(i, j) += a(i, k) * b.packed[b.Index(k, j)];
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, Triangle Kind>
+TriangularMatrix<T, N, Kind> operator*(const TriangularMatrix<T, N, Kind>& a, const TriangularMatrix<T, N, Kind>& b) {
+  TriangularMatrix<T, N, Kind> result{};
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < N; j++) {
+      if (!result.IsStored(i, j)) {
+        continue;
+      }
+      size_t begin = Kind == Triangle::kUpper ? i : j;
+      size_t end = Kind == Triangle::kUpper ? j + 1 : i + 1;
+      for (size_t k = begin; k < end; k++) {
+        result(i, j) += a.packed[a.Index(i, k)] * b.packed[b.Index(k, j)];
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M, size_t Lower, size_t Upper>
+Matrix<T, N, M> operator*(const BandedMatrix<T, N, Lower, Upper>& a, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result{};
+  for (size_t i = 0; i < N; i++) {
+    for (size_t k = a.GetBegin(i); k < a.GetEnd(i); k++) {
+      const T& value = a.band[i][k + Lower - i];
+      for (size_t j = 0; j < M; j++) {
+        result(i, j) += value * b(k, j);
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M, size_t Lower, size_t Upper>
+Matrix<T, M, N> operator*(const Matrix<T, M, N>& a, const BandedMatrix<T, N, Lower, Upper>& b) {
+  Matrix<T, M, N> result{};
+  for (size_t i = 0; i < M; i++) {
+    for (size_t k = 0; k < N; k++) {
+      for (size_t j = b.GetBegin(k); j < b.GetEnd(k); j++) {
+        result(i, j) += a(i, k) * b.band[k][j + Lower - k];
+      }
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N>
+DiagonalMatrix<T, N> GetTransposed(const DiagonalMatrix<T, N>& matrix) {
+  return matrix;
+}
+
+template <class T, size_t N>
+SymmetricMatrix<T, N> GetTransposed(const SymmetricMatrix<T, N>& matrix) {
+  return matrix;
+}
+
+template <class T, size_t N>
+void Transpose(DiagonalMatrix<T, N>&) {
+}
+
+template <class T, size_t N>
+void Transpose(SymmetricMatrix<T, N>&) {
+}
+
+template <class T, size_t N, Triangle Kind>
+TriangularMatrix<T, N, Kind == Triangle::kUpper ? Triangle::kLower : Triangle::kUpper> GetTransposed(const TriangularMatrix<T, N, Kind>& matrix) {
+  TriangularMatrix<T, N, Kind == Triangle::kUpper ? Triangle::kLower : Triangle::kUpper> result;
+  std::copy(matrix.packed, matrix.packed + N * (N + 1) / 2, result.packed);
+  return result;
+}
+
+template <class T, size_t N, size_t Lower, size_t Upper>
+BandedMatrix<T, N, Upper, Lower> GetTransposed(const BandedMatrix<T, N, Lower, Upper>& matrix) {
+  BandedMatrix<T, N, Upper, Lower> result{};
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = matrix.GetBegin(i); j < matrix.GetEnd(i); j++) {
+      result(j, i) = matrix.band[i][j + Lower - i];
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N>
+T Determinant(const DiagonalMatrix<T, N>& matrix) {
+  T result = matrix.diagonal[0];
+  for (size_t i = 1; i < N; i++) {
+    result *= matrix.diagonal[i];
+  }
+  return result;
+}
+
+template <class T, size_t N, Triangle Kind>
+T Determinant(const TriangularMatrix<T, N, Kind>& matrix) {
+  T result = matrix.packed[matrix.Index(0, 0)];
+  for (size_t i = 1; i < N; i++) {
+    result *= matrix.packed[matrix.Index(i, i)];
+  }
+  return result;
+}
+
+template <class T, size_t N>
+T Determinant(const SymmetricMatrix<T, N>& matrix) {
+  return Determinant(ToMatrix(matrix));
+}
+
+template <class T, size_t N, size_t Lower, size_t Upper>
+T Determinant(const BandedMatrix<T, N, Lower, Upper>& matrix) {
+  return Determinant(ToMatrix(matrix));
+}
+
+// Solves matrix * x = b.
+template <class T, size_t N, size_t M>
+Matrix<T, N, M> Solve(const DiagonalMatrix<T, N>& matrix, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result;
+  for (size_t i = 0; i < N; i++) {
+    if (matrix.diagonal[i] == 0) {
+      throw MatrixIsDegenerateError{};
+    }
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) = b(i, j) / matrix.diagonal[i];
+    }
+  }
+  return result;
+}
+
+// Forward substitution for a lower triangular matrix, back substitution for an upper one.
+template <class T, size_t N, size_t M, Triangle Kind>
+Matrix<T, N, M> Solve(const TriangularMatrix<T, N, Kind>& matrix, const Matrix<T, N, M>& b) {
+  Matrix<T, N, M> result = b;
+  for (size_t step = 0; step < N; step++) {
+    size_t i = Kind == Triangle::kLower ? step : N - 1 - step;
+    size_t begin = Kind == Triangle::kLower ? 0 : i + 1;
+    size_t end = Kind == Triangle::kLower ? i : N;
+    for (size_t k = begin; k < end; k++) {
+      const T& value = matrix.packed[matrix.Index(i, k)];
+      for (size_t j = 0; j < M; j++) {
+        result(i, j) -= value * result(k, j);
+      }
+    }
+    const T& pivot = matrix.packed[matrix.Index(i, i)];
+    if (pivot == 0) {
+      throw MatrixIsDegenerateError{};
+    }
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) /= pivot;
+    }
+  }
+  return result;
+}
+
+#endif
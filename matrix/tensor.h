@@ -0,0 +1,344 @@
+#ifndef TENSOR_H_
+#define TENSOR_H_
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "matrix.h"
+
+class TensorOutOfRange : public std::out_of_range {
+ public:
+  TensorOutOfRange() : std::out_of_range("TensorOutOfRange") {
+  }
+};
+
+template <size_t Rank>
+constexpr std::array<size_t, Rank> GetContiguousStrides(const std::array<size_t, Rank>& dims) {
+  std::array<size_t, Rank> strides{};
+  size_t stride = 1;
+  for (size_t k = Rank; k > 0; k--) {
+    strides[k - 1] = stride;
+    stride *= dims[k - 1];
+  }
+  return strides;
+}
+
+template <class Dims, class = std::make_index_sequence<Dims::size()>>
+struct TensorStrides;
+
+template <size_t... Dims, size_t... I>
+struct TensorStrides<std::index_sequence<Dims...>, std::index_sequence<I...>> {
+  static constexpr std::array<size_t, sizeof...(Dims)> kStrides = GetContiguousStrides<sizeof...(Dims)>({Dims...});
+  using Type = std::index_sequence<kStrides[I]...>;
+};
+
+// Turns the std::array returned by Generator::Get() into a std::index_sequence.
+template <class Generator, class = std::make_index_sequence<Generator::Get().size()>>
+struct TensorSequence;
+
+template <class Generator, size_t... I>
+struct TensorSequence<Generator, std::index_sequence<I...>> {
+  using Type = std::index_sequence<Generator::Get()[I]...>;
+};
+
+template <class T, class Dims, class Strides>
+class TensorView;
+
+// A non-owning view of tensor data with compile-time shape and strides, produced by Permute and Reshape.
+template <class T, size_t... Dims, size_t... Strides>
+class TensorView<T, std::index_sequence<Dims...>, std::index_sequence<Strides...>> {
+ public:
+  using ValueType = T;
+
+  static constexpr size_t kRank = sizeof...(Dims);
+  static constexpr size_t kSize = (Dims * ... * size_t{1});
+  static constexpr std::array<size_t, kRank> kDims{Dims...};
+  static constexpr std::array<size_t, kRank> kStrides{Strides...};
+  static constexpr bool kContiguous = std::is_same_v<typename TensorStrides<std::index_sequence<Dims...>>::Type, std::index_sequence<Strides...>>;
+
+  explicit TensorView(T* data) : data_{data} {
+  }
+
+  template <class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  TensorView(const TensorView<U, std::index_sequence<Dims...>, std::index_sequence<Strides...>>& other)  // NOLINT
+      : data_{other.Data()} {
+  }
+
+  size_t Rank() const {
+    return kRank;
+  }
+
+  size_t Size() const {
+    return kSize;
+  }
+
+  T* Data() const {
+    return data_;
+  }
+
+  template <class... Indices>
+  T& operator()(Indices... indices) const {
+    static_assert(sizeof...(Indices) == kRank, "wrong number of indices");
+    return data_[((static_cast<size_t>(indices) * Strides) + ... + size_t{0})];
+  }
+
+  template <class... Indices>
+  T& At(Indices... indices) const {
+    static_assert(sizeof...(Indices) == kRank, "wrong number of indices");
+    if (((static_cast<size_t>(indices) >= Dims) || ... || false)) {
+      throw TensorOutOfRange{};
+    }
+    return operator()(indices...);
+  }
+
+  // Writes the elements to out in row-major order of this view.
+  void CopyTo(std::remove_const_t<T>* out) const {
+    std::array<size_t, kRank> index{};
+    size_t offset = 0;
+    for (size_t n = 0; n < kSize; n++) {
+      out[n] = data_[offset];
+      for (size_t k = kRank; k > 0; k--) {
+        offset += kStrides[k - 1];
+        if (++index[k - 1] < kDims[k - 1]) {
+          break;
+        }
+        offset -= kStrides[k - 1] * kDims[k - 1];
+        index[k - 1] = 0;
+      }
+    }
+  }
+
+ private:
+  T* data_;
+};
+
+template <class T, size_t... Dims>
+using ContiguousTensorView = TensorView<T, std::index_sequence<Dims...>, typename TensorStrides<std::index_sequence<Dims...>>::Type>;
+
+template <class T, size_t... Dims>
+class Tensor {
+  static_assert(((Dims > 0) && ... && true), "tensor dimensions must be positive");
+
+ public:
+  using ValueType = T;
+
+  static constexpr size_t kRank = sizeof...(Dims);
+  static constexpr size_t kSize = (Dims * ... * size_t{1});
+
+  T tensor[kSize];
+
+  size_t Rank() const {
+    return kRank;
+  }
+
+  size_t Size() const {
+    return kSize;
+  }
+
+  T* Data() {
+    return tensor;
+  }
+
+  const T* Data() const {
+    return tensor;
+  }
+
+  template <class... Indices>
+  T& operator()(Indices... indices) {
+    return View()(indices...);
+  }
+
+  template <class... Indices>
+  const T& operator()(Indices... indices) const {
+    return View()(indices...);
+  }
+
+  template <class... Indices>
+  T& At(Indices... indices) {
+    return View().At(indices...);
+  }
+
+  template <class... Indices>
+  const T& At(Indices... indices) const {
+    return View().At(indices...);
+  }
+
+  ContiguousTensorView<T, Dims...> View() {
+    return ContiguousTensorView<T, Dims...>(tensor);
+  }
+
+  ContiguousTensorView<const T, Dims...> View() const {
+    return ContiguousTensorView<const T, Dims...>(tensor);
+  }
+};
+
+template <class T, size_t... Dims>
+bool operator==(const Tensor<T, Dims...>& a, const Tensor<T, Dims...>& b) {
+  for (size_t i = 0; i < Tensor<T, Dims...>::kSize; i++) {
+    if (a.tensor[i] != b.tensor[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, size_t... Dims>
+bool operator!=(const Tensor<T, Dims...>& a, const Tensor<T, Dims...>& b) {
+  return !(a == b);
+}
+
+template <class T, size_t N, size_t M>
+Tensor<T, N, M> ToTensor(const Matrix<T, N, M>& matrix) {
+  Tensor<T, N, M> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) = matrix(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, size_t N, size_t M>
+Matrix<T, N, M> ToMatrix(const Tensor<T, N, M>& tensor) {
+  Matrix<T, N, M> result;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < M; j++) {
+      result(i, j) = tensor(i, j);
+    }
+  }
+  return result;
+}
+
+template <class T, class Dims, class Strides>
+TensorView<T, Dims, Strides> GetTensorView(const TensorView<T, Dims, Strides>& view) {
+  return view;
+}
+
+template <class T, size_t... Dims>
+ContiguousTensorView<T, Dims...> GetTensorView(Tensor<T, Dims...>& tensor) {
+  return tensor.View();
+}
+
+template <class T, size_t... Dims>
+ContiguousTensorView<const T, Dims...> GetTensorView(const Tensor<T, Dims...>& tensor) {
+  return tensor.View();
+}
+
+template <size_t Rank, size_t... Axes>
+constexpr bool IsTensorPermutation() {
+  std::array<bool, Rank> seen{};
+  for (size_t axis : std::array<size_t, sizeof...(Axes)>{Axes...}) {
+    if (axis >= Rank || seen[axis]) {
+      return false;
+    }
+    seen[axis] = true;
+  }
+  return sizeof...(Axes) == Rank;
+}
+
+// Returns a view whose k-th axis is the Axes[k]-th axis of the argument.
+template <size_t... Axes, class Source>
+auto Permute(Source&& source) {
+  auto view = GetTensorView(source);
+  using View = decltype(view);
+  static_assert(IsTensorPermutation<View::kRank, Axes...>(), "axes must be a permutation");
+  using Result = TensorView<typename View::ValueType, std::index_sequence<View::kDims[Axes]...>, std::index_sequence<View::kStrides[Axes]...>>;
+  return Result(view.Data());
+}
+
+template <size_t... NewDims, class Source>
+auto Reshape(Source&& source) {
+  auto view = GetTensorView(source);
+  using View = decltype(view);
+  static_assert(View::kContiguous, "only contiguous views can be reshaped without a copy");
+  static_assert((NewDims * ... * size_t{1}) == View::kSize, "reshape must preserve the number of elements");
+  return ContiguousTensorView<typename View::ValueType, NewDims...>(view.Data());
+}
+
+template <size_t Rank, size_t... Axes>
+struct TensorFreeAxes {
+  static constexpr std::array<size_t, Rank - sizeof...(Axes)> Get() {
+    std::array<size_t, Rank - sizeof...(Axes)> result{};
+    size_t count = 0;
+    for (size_t axis = 0; axis < Rank; axis++) {
+      if (((axis != Axes) && ... && true)) {
+        result[count++] = axis;
+      }
+    }
+    return result;
+  }
+};
+
+template <class ViewA, class ViewB, class AxesA, class AxesB>
+struct TensorContraction;
+
+// Permutes the free axes of a to the front and those of b to the back, so that the contraction becomes a single
+// (free a) x (contracted) by (contracted) x (free b) matrix product. Operands that are not contiguous after the
+// permutation are packed first.
+template <class ViewA, class ViewB, size_t... AxesA, size_t... AxesB>
+struct TensorContraction<ViewA, ViewB, std::index_sequence<AxesA...>, std::index_sequence<AxesB...>> {
+  using ValueType = std::remove_const_t<typename ViewA::ValueType>;
+
+  static_assert(std::is_same_v<ValueType, std::remove_const_t<typename ViewB::ValueType>>, "tensors must have the same element type");
+  static_assert(sizeof...(AxesA) == sizeof...(AxesB), "the same number of axes must be contracted on both sides");
+  static_assert(((AxesA < ViewA::kRank) && ... && true) && ((AxesB < ViewB::kRank) && ... && true), "axis out of range");
+  static_assert(((ViewA::kDims[AxesA] == ViewB::kDims[AxesB]) && ... && true), "contracted axes must have equal sizes");
+
+  using FreeA = typename TensorSequence<TensorFreeAxes<ViewA::kRank, AxesA...>>::Type;
+  using FreeB = typename TensorSequence<TensorFreeAxes<ViewB::kRank, AxesB...>>::Type;
+
+  template <size_t... FreeAxesA, size_t... FreeAxesB>
+  static auto MakeResult(std::index_sequence<FreeAxesA...>, std::index_sequence<FreeAxesB...>) -> Tensor<ValueType, ViewA::kDims[FreeAxesA]..., ViewB::kDims[FreeAxesB]...>;
+
+  using Result = decltype(MakeResult(FreeA{}, FreeB{}));
+
+  template <size_t... FreeAxesA, size_t... FreeAxesB>
+  static Result Run(ViewA a, ViewB b, std::index_sequence<FreeAxesA...>, std::index_sequence<FreeAxesB...>) {
+    constexpr size_t kRows = (ViewA::kDims[FreeAxesA] * ... * size_t{1});
+    constexpr size_t kDepth = (ViewA::kDims[AxesA] * ... * size_t{1});
+    constexpr size_t kColumns = (ViewB::kDims[FreeAxesB] * ... * size_t{1});
+    std::unique_ptr<ValueType[]> a_buffer, b_buffer;
+    const ValueType* a_data = Pack(Permute<FreeAxesA..., AxesA...>(a), a_buffer);
+    const ValueType* b_data = Pack(Permute<AxesB..., FreeAxesB...>(b), b_buffer);
+    Result result{};
+    MultiplyAddBlocked(kRows, kDepth, kColumns, a_data, kDepth, b_data, kColumns, result.Data(), kColumns);
+    return result;
+  }
+
+  template <class View>
+  static const ValueType* Pack(View view, std::unique_ptr<ValueType[]>& buffer) {
+    if constexpr (View::kContiguous) {
+      return view.Data();
+    } else {
+      buffer = std::make_unique<ValueType[]>(View::kSize);
+      view.CopyTo(buffer.get());
+      return buffer.get();
+    }
+  }
+};
+
+// Sums over pairs of axes (AxesA[k] of a, AxesB[k] of b); the result has the remaining axes of a followed by the
+// remaining axes of b. Example: Contract<std::index_sequence<2>, std::index_sequence<0>>(a, b).
+template <class AxesA, class AxesB, class A, class B>
+auto Contract(const A& a, const B& b) {
+  auto view_a = GetTensorView(a);
+  auto view_b = GetTensorView(b);
+  using Contraction = TensorContraction<decltype(view_a), decltype(view_b), AxesA, AxesB>;
+  return Contraction::Run(view_a, view_b, typename Contraction::FreeA{}, typename Contraction::FreeB{});
+}
+
+template <size_t Offset, size_t... I>
+std::index_sequence<(Offset + I)...> ShiftTensorAxes(std::index_sequence<I...>);
+
+// Contracts the last K axes of a with the first K axes of b.
+template <size_t K, class A, class B>
+auto Contract(const A& a, const B& b) {
+  using ViewA = decltype(GetTensorView(a));
+  using AxesA = decltype(ShiftTensorAxes<ViewA::kRank - K>(std::make_index_sequence<K>{}));
+  return Contract<AxesA, std::make_index_sequence<K>>(a, b);
+}
+
+#endif
@@ -1,12 +1,23 @@
 #ifndef RANGE_H_
 #define RANGE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
 #define REVERSE_RANGE_IMPLEMENTED
 
 class Range {
  public:
   class Iterator {
    public:
+    // Dereferencing yields a value rather than a reference, which makes this an input iterator.
+    using iterator_category = std::input_iterator_tag;  // NOLINT
+    using value_type = int64_t;                         // NOLINT
+    using difference_type = std::ptrdiff_t;             // NOLINT
+    using pointer = const int64_t*;                     // NOLINT
+    using reference = int64_t;                          // NOLINT
+
     explicit Iterator(int64_t start, int64_t stop, int64_t step, int64_t value)
         : start_{start}, stop_{stop}, step_{step}, value_{value} {
     }
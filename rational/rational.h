@@ -56,4 +56,12 @@ class Rational {
   void Reduce();
 };
 
+template <class T>
+struct MatrixMultiplier;
+
+// Defined in matrix/rational_matrix.h. Declaring it here makes multiplying Matrix<Rational> without that header a
+// compile error instead of a silent instantiation of the generic kernel.
+template <>
+struct MatrixMultiplier<Rational>;
+
 #endif
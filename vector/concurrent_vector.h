@@ -0,0 +1,198 @@
+#ifndef CONCURRENT_VECTOR_H_
+#define CONCURRENT_VECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Vector that many threads append to at once without a lock. A slot is claimed by incrementing an atomic counter;
+// storage is a table of segments, the first holding kFirstSegmentSize elements and every next one twice as many as
+// the previous, allocated on first use and never moved, so references stay valid for the container's lifetime. An
+// element is published with a release store of its flag once constructed: At and IsPublished may be called by any
+// thread for any index, while operator[] is for elements whose publication the caller already observed. Clear and
+// destruction must not run concurrently with other calls.
+template <class T>
+class ConcurrentVector {
+ public:
+  using ValueType = T;
+  using Reference = T&;
+  using ConstReference = const T&;
+  using SizeType = size_t;
+
+  static constexpr SizeType kFirstSegmentSize = 8;
+
+  ConcurrentVector() = default;
+
+  ConcurrentVector(const ConcurrentVector&) = delete;
+  ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+  ~ConcurrentVector() {
+    Clear();
+    for (auto& segment : segments_) {
+      if (Segment* pointer = segment.load(std::memory_order_relaxed)) {
+        DeallocateSegment(pointer, static_cast<SizeType>(&segment - segments_));
+      }
+    }
+  }
+
+  // Number of claimed slots, including those whose elements are still being constructed (or whose construction
+  // threw; such slots are never published).
+  SizeType Size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  bool Empty() const {
+    return Size() == 0;
+  }
+
+  bool IsPublished(SizeType index) const {
+    if (index >= Size()) {
+      return false;
+    }
+    const auto [segment, offset] = Locate(index);
+    const Segment* pointer = segments_[segment].load(std::memory_order_acquire);
+    return pointer != nullptr && pointer->published[offset].load(std::memory_order_acquire);
+  }
+
+  Reference operator[](SizeType index) {
+    const auto [segment, offset] = Locate(index);
+    return segments_[segment].load(std::memory_order_acquire)->elements[offset];
+  }
+
+  ConstReference operator[](SizeType index) const {
+    const auto [segment, offset] = Locate(index);
+    return segments_[segment].load(std::memory_order_acquire)->elements[offset];
+  }
+
+  Reference At(SizeType index) {
+    if (IsPublished(index)) {
+      return (*this)[index];
+    }
+    throw std::out_of_range("Reference At(SizeType)");
+  }
+
+  ConstReference At(SizeType index) const {
+    if (IsPublished(index)) {
+      return (*this)[index];
+    }
+    throw std::out_of_range("ConstReference At(SizeType)");
+  }
+
+  // Allocates the segments for the first new_capacity elements in advance.
+  void Reserve(SizeType new_capacity) {
+    if (new_capacity == 0) {
+      return;
+    }
+    const SizeType last = Locate(new_capacity - 1).first;
+    for (SizeType segment = 0; segment <= last; segment++) {
+      GetSegment(segment);
+    }
+  }
+
+  Reference PushBack(const ValueType& value) {
+    return EmplaceBack(value);
+  }
+
+  Reference PushBack(ValueType&& value) {
+    return EmplaceBack(std::move(value));
+  }
+
+  template <class... Args>
+  Reference EmplaceBack(Args&&... args) {
+    const SizeType index = size_.fetch_add(1, std::memory_order_acq_rel);
+    const auto [segment, offset] = Locate(index);
+    Segment* pointer = GetSegment(segment);
+    Reference element = *new (pointer->elements + offset) ValueType(std::forward<Args>(args)...);
+    pointer->published[offset].store(true, std::memory_order_release);
+    return element;
+  }
+
+  // Destroys the elements but keeps the segments. Not thread-safe.
+  void Clear() {
+    const SizeType size = size_.load(std::memory_order_relaxed);
+    for (SizeType index = 0; index < size; index++) {
+      const auto [segment, offset] = Locate(index);
+      Segment* pointer = segments_[segment].load(std::memory_order_relaxed);
+      if (pointer != nullptr && pointer->published[offset].load(std::memory_order_relaxed)) {
+        std::destroy_at(pointer->elements + offset);
+        pointer->published[offset].store(false, std::memory_order_relaxed);
+      }
+    }
+    size_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  // Header of a segment allocation, followed by the flags and then the elements.
+  struct Segment {
+    ValueType* elements;
+    std::atomic<bool>* published;
+  };
+
+  static constexpr SizeType kMaxSegments = sizeof(SizeType) * 8 - 3;
+
+  std::atomic<SizeType> size_{0};
+  std::atomic<Segment*> segments_[kMaxSegments] = {};
+
+  static SizeType GetSegmentSize(SizeType segment) {
+    return kFirstSegmentSize << segment;
+  }
+
+  // Segment s holds the indices [kFirstSegmentSize * (2^s - 1), kFirstSegmentSize * (2^(s + 1) - 1)).
+  static std::pair<SizeType, SizeType> Locate(SizeType index) {
+    const SizeType block = index / kFirstSegmentSize + 1;
+    const SizeType segment = sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(block);
+    return {segment, index - kFirstSegmentSize * ((SizeType{1} << segment) - 1)};
+  }
+
+  static size_t GetFlagsOffset() {
+    return (sizeof(Segment) + alignof(std::atomic<bool>) - 1) / alignof(std::atomic<bool>) * alignof(std::atomic<bool>);
+  }
+
+  static size_t GetElementsOffset(SizeType size) {
+    const size_t end = GetFlagsOffset() + size * sizeof(std::atomic<bool>);
+    return (end + alignof(ValueType) - 1) / alignof(ValueType) * alignof(ValueType);
+  }
+
+  static size_t GetAllocationSize(SizeType size) {
+    return GetElementsOffset(size) + size * sizeof(ValueType);
+  }
+
+  static constexpr size_t GetAllocationAlignment() {
+    return alignof(ValueType) > alignof(Segment) ? alignof(ValueType) : alignof(Segment);
+  }
+
+  static Segment* AllocateSegment(SizeType segment) {
+    const SizeType size = GetSegmentSize(segment);
+    auto memory = static_cast<char*>(operator new(GetAllocationSize(size), std::align_val_t{GetAllocationAlignment()}));
+    auto pointer = new (memory) Segment{reinterpret_cast<ValueType*>(memory + GetElementsOffset(size)), reinterpret_cast<std::atomic<bool>*>(memory + GetFlagsOffset())};
+    for (SizeType i = 0; i < size; i++) {
+      new (pointer->published + i) std::atomic<bool>(false);
+    }
+    return pointer;
+  }
+
+  static void DeallocateSegment(Segment* pointer, SizeType segment) {
+    operator delete(static_cast<void*>(pointer), GetAllocationSize(GetSegmentSize(segment)), std::align_val_t{GetAllocationAlignment()});
+  }
+
+  // Returns the segment, allocating it if needed. Threads that race to allocate the same segment all allocate, one
+  // installs its segment with a compare-and-swap and the others free theirs.
+  Segment* GetSegment(SizeType segment) {
+    Segment* pointer = segments_[segment].load(std::memory_order_acquire);
+    if (pointer != nullptr) {
+      return pointer;
+    }
+    Segment* fresh = AllocateSegment(segment);
+    if (segments_[segment].compare_exchange_strong(pointer, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return fresh;
+    }
+    DeallocateSegment(fresh, segment);
+    return pointer;
+  }
+};
+
+#endif
@@ -0,0 +1,437 @@
+#ifndef MAPPED_VECTOR_H_
+#define MAPPED_VECTOR_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+class MappedVectorFormatError : public std::runtime_error {
+ public:
+  explicit MappedVectorFormatError(const std::string& path) : std::runtime_error("MappedVectorFormatError: " + path) {
+  }
+};
+
+enum class MappedVectorMode {
+  kReadOnly,   // the file must exist; only const access is allowed, non-const accessors throw std::logic_error
+  kReadWrite,  // the file is created if missing
+};
+
+// Leading bytes of a MappedVector file; the elements follow at offset sizeof(MappedVectorHeader).
+struct MappedVectorHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t element_size;
+  uint64_t size;
+  uint64_t reserved[5];
+};
+
+static_assert(sizeof(MappedVectorHeader) == 64);
+
+constexpr char kMappedVectorMagic[8] = {'M', 'A', 'P', 'V', 'E', 'C', 'T', 'R'};
+constexpr uint32_t kMappedVectorVersion = 1;
+
+// Array of trivially copyable T kept in a file mapped with MAP_SHARED: opening takes constant time whatever the size,
+// pages are read on first access, and every change goes to the file. The capacity is the room in the file past the
+// header, grown with ftruncate and mremap; the size lives in the header. The file format is the header followed by
+// the raw elements, so it is only portable between machines with the same representation of T.
+template <class T>
+class MappedVector {
+  static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores the bytes of its elements");
+  static_assert(alignof(T) <= sizeof(MappedVectorHeader), "MappedVector elements follow a 64-byte header");
+
+ public:
+  using ValueType = T;
+  using Pointer = T*;
+  using ConstPointer = const T*;
+  using Reference = T&;
+  using ConstReference = const T&;
+  using SizeType = size_t;
+  using Iterator = Pointer;
+  using ConstIterator = ConstPointer;
+  using ReverseIterator = std::reverse_iterator<Iterator>;
+  using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+  explicit MappedVector(const std::string& path, MappedVectorMode mode = MappedVectorMode::kReadWrite)
+      : writable_{mode == MappedVectorMode::kReadWrite} {
+    descriptor_ = writable_ ? open(path.c_str(), O_RDWR | O_CREAT, 0644) : open(path.c_str(), O_RDONLY);
+    if (descriptor_ < 0) {
+      throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    try {
+      struct stat status {};
+      if (fstat(descriptor_, &status) != 0) {
+        throw std::system_error(errno, std::generic_category(), "fstat " + path);
+      }
+      auto file_size = static_cast<size_t>(status.st_size);
+      if (file_size == 0 && writable_) {
+        Truncate(kHeaderSize);
+        file_size = kHeaderSize;
+      }
+      if (file_size < kHeaderSize) {
+        throw MappedVectorFormatError(path);
+      }
+      Map(file_size);
+      if (status.st_size == 0) {
+        MappedVectorHeader& header = GetHeader();
+        std::memcpy(header.magic, kMappedVectorMagic, sizeof(header.magic));
+        header.version = kMappedVectorVersion;
+        header.element_size = sizeof(ValueType);
+      }
+      const MappedVectorHeader& header = GetHeader();
+      capacity_ = (file_size - kHeaderSize) / sizeof(ValueType);
+      if (std::memcmp(header.magic, kMappedVectorMagic, sizeof(header.magic)) != 0 || header.version != kMappedVectorVersion || header.element_size != sizeof(ValueType) || header.size > capacity_) {
+        throw MappedVectorFormatError(path);
+      }
+    } catch (...) {
+      Close();
+      throw;
+    }
+  }
+
+  MappedVector(const MappedVector&) = delete;
+  MappedVector& operator=(const MappedVector&) = delete;
+
+  MappedVector(MappedVector&& other) noexcept
+      : descriptor_{std::exchange(other.descriptor_, -1)}
+      , mapping_{std::exchange(other.mapping_, nullptr)}
+      , mapping_size_{std::exchange(other.mapping_size_, 0)}
+      , capacity_{std::exchange(other.capacity_, 0)}
+      , writable_{other.writable_} {
+  }
+
+  MappedVector& operator=(MappedVector&& other) noexcept {
+    if (this != &other) {
+      Close();
+      descriptor_ = std::exchange(other.descriptor_, -1);
+      mapping_ = std::exchange(other.mapping_, nullptr);
+      mapping_size_ = std::exchange(other.mapping_size_, 0);
+      capacity_ = std::exchange(other.capacity_, 0);
+      writable_ = other.writable_;
+    }
+    return *this;
+  }
+
+  ~MappedVector() {
+    Close();
+  }
+
+  SizeType Size() const {
+    return mapping_ == nullptr ? 0 : GetHeader().size;
+  }
+
+  SizeType Capacity() const {
+    return capacity_;
+  }
+
+  bool Empty() const {
+    return Size() == 0;
+  }
+
+  bool IsWritable() const {
+    return writable_;
+  }
+
+  Reference operator[](SizeType index) {
+    return Data()[index];
+  }
+
+  ConstReference operator[](SizeType index) const {
+    return Data()[index];
+  }
+
+  Reference At(SizeType index) {
+    if (index < Size()) {
+      return Data()[index];
+    }
+    throw std::out_of_range("Reference At(SizeType)");
+  }
+
+  ConstReference At(SizeType index) const {
+    if (index < Size()) {
+      return Data()[index];
+    }
+    throw std::out_of_range("ConstReference At(SizeType)");
+  }
+
+  Reference Front() {
+    if (Size() > 0) {
+      return Data()[0];
+    }
+    throw std::out_of_range("Reference Front()");
+  }
+
+  ConstReference Front() const {
+    if (Size() > 0) {
+      return Data()[0];
+    }
+    throw std::out_of_range("ConstReference Front()");
+  }
+
+  Reference Back() {
+    if (Size() > 0) {
+      return Data()[Size() - 1];
+    }
+    throw std::out_of_range("Reference Back()");
+  }
+
+  ConstReference Back() const {
+    if (Size() > 0) {
+      return Data()[Size() - 1];
+    }
+    throw std::out_of_range("ConstReference Back()");
+  }
+
+  // The non-const accessors all go through here, so that a read-only mapping never hands out a mutable reference into
+  // memory mapped without PROT_WRITE.
+  Pointer Data() {
+    CheckWritable();
+    return GetElements();
+  }
+
+  ConstPointer Data() const {
+    return reinterpret_cast<ConstPointer>(mapping_ + kHeaderSize);
+  }
+
+  // New elements are zero bytes.
+  void Resize(SizeType new_size) {
+    CheckWritable();
+    Reserve(new_size);
+    const SizeType size = Size();
+    if (new_size > size) {
+      std::memset(static_cast<void*>(GetElements() + size), 0, (new_size - size) * sizeof(ValueType));
+    }
+    GetHeader().size = new_size;
+  }
+
+  void Resize(SizeType new_size, const ValueType& value) {
+    CheckWritable();
+    const ValueType copy = value;
+    Reserve(new_size);
+    const SizeType size = Size();
+    if (new_size > size) {
+      std::fill(GetElements() + size, GetElements() + new_size, copy);
+    }
+    GetHeader().size = new_size;
+  }
+
+  void Reserve(SizeType new_capacity) {
+    CheckWritable();
+    if (new_capacity > capacity_) {
+      Remap(new_capacity);
+    }
+  }
+
+  // Truncates the file to the elements.
+  void ShrinkToFit() {
+    CheckWritable();
+    if (Size() < capacity_) {
+      Remap(Size());
+    }
+  }
+
+  void Clear() {
+    CheckWritable();
+    GetHeader().size = 0;
+  }
+
+  void PushBack(const ValueType& value) {
+    EmplaceBack(value);
+  }
+
+  template <class... Args>
+  Reference EmplaceBack(Args&&... args) {
+    CheckWritable();
+    const ValueType value(std::forward<Args>(args)...);
+    const SizeType size = Size();
+    if (size == capacity_) {
+      Remap(std::max<SizeType>(capacity_ * 2, kMinCapacity));
+    }
+    new (GetElements() + size) ValueType(value);
+    GetHeader().size = size + 1;
+    return GetElements()[size];
+  }
+
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIterator>::iterator_category>>>
+  void Append(InputIterator first, InputIterator last) {
+    CheckWritable();
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIterator>::iterator_category>) {
+      const SizeType size = Size();
+      const SizeType count = std::distance(first, last);
+      if (size + count > capacity_) {
+        // Remap may move the mapping, so a range of the vector itself is followed by its offset.
+        if constexpr (std::is_pointer_v<InputIterator>) {
+          const ValueType* data = GetElements();
+          if (count > 0 && std::less_equal<const ValueType*>()(data, first) && std::less<const ValueType*>()(first, data + size)) {
+            const SizeType offset = first - data;
+            Remap(std::max(size + count, capacity_ * 2));
+            std::copy_n(GetElements() + offset, count, GetElements() + size);
+            GetHeader().size = size + count;
+            return;
+          }
+        }
+        Remap(std::max(size + count, capacity_ * 2));
+      }
+      std::copy(first, last, GetElements() + size);
+      GetHeader().size = size + count;
+    } else {
+      for (; first != last; ++first) {
+        EmplaceBack(*first);
+      }
+    }
+  }
+
+  void PopBack() {
+    CheckWritable();
+    if (Size() == 0) {
+      throw std::out_of_range("PopBack()");
+    }
+    GetHeader().size--;
+  }
+
+  // Writes the changed pages to the file and waits for the write to finish.
+  void Sync() {
+    if (mapping_ != nullptr && writable_ && msync(mapping_, mapping_size_, MS_SYNC) != 0) {
+      throw std::system_error(errno, std::generic_category(), "msync");
+    }
+  }
+
+  Iterator begin() {  // NOLINT
+    return Data();
+  }
+
+  ConstIterator begin() const {  // NOLINT
+    return Data();
+  }
+
+  ConstIterator cbegin() const {  // NOLINT
+    return Data();
+  }
+
+  Iterator end() {  // NOLINT
+    return Data() + Size();
+  }
+
+  ConstIterator end() const {  // NOLINT
+    return Data() + Size();
+  }
+
+  ConstIterator cend() const {  // NOLINT
+    return Data() + Size();
+  }
+
+  ReverseIterator rbegin() {  // NOLINT
+    return ReverseIterator(end());
+  }
+
+  ConstReverseIterator rbegin() const {  // NOLINT
+    return ConstReverseIterator(end());
+  }
+
+  ConstReverseIterator crbegin() const {  // NOLINT
+    return ConstReverseIterator(end());
+  }
+
+  ReverseIterator rend() {  // NOLINT
+    return ReverseIterator(begin());
+  }
+
+  ConstReverseIterator rend() const {  // NOLINT
+    return ConstReverseIterator(begin());
+  }
+
+  ConstReverseIterator crend() const {  // NOLINT
+    return ConstReverseIterator(begin());
+  }
+
+ private:
+  static constexpr size_t kHeaderSize = sizeof(MappedVectorHeader);
+  // Keeps the first growth steps from resizing the file for every element.
+  static constexpr size_t kMinCapacity = 4096 / sizeof(ValueType) > 0 ? 4096 / sizeof(ValueType) : 1;
+
+  int descriptor_ = -1;
+  char* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  SizeType capacity_ = 0;
+  bool writable_;
+
+  MappedVectorHeader& GetHeader() {
+    return *reinterpret_cast<MappedVectorHeader*>(mapping_);
+  }
+
+  const MappedVectorHeader& GetHeader() const {
+    return *reinterpret_cast<const MappedVectorHeader*>(mapping_);
+  }
+
+  Pointer GetElements() {
+    return reinterpret_cast<Pointer>(mapping_ + kHeaderSize);
+  }
+
+  void CheckWritable() const {
+    if (!writable_) {
+      throw std::logic_error("MappedVector is read-only");
+    }
+  }
+
+  void Truncate(size_t file_size) {
+    if (ftruncate(descriptor_, static_cast<off_t>(file_size)) != 0) {
+      throw std::system_error(errno, std::generic_category(), "ftruncate");
+    }
+  }
+
+  void Map(size_t file_size) {
+    const int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapping = mmap(nullptr, file_size, protection, MAP_SHARED, descriptor_, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    mapping_ = static_cast<char*>(mapping);
+    mapping_size_ = file_size;
+  }
+
+  // Resizes the file and the mapping to new_capacity elements. The file is grown before the mapping and shrunk after
+  // it, so that no mapped page is ever past the end of the file.
+  void Remap(SizeType new_capacity) {
+    const size_t file_size = kHeaderSize + new_capacity * sizeof(ValueType);
+    if (file_size > mapping_size_) {
+      Truncate(file_size);
+    }
+    void* mapping = mremap(mapping_, mapping_size_, file_size, MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+      throw std::system_error(errno, std::generic_category(), "mremap");
+    }
+    mapping_ = static_cast<char*>(mapping);
+    mapping_size_ = file_size;
+    if (file_size < kHeaderSize + capacity_ * sizeof(ValueType)) {
+      Truncate(file_size);
+    }
+    capacity_ = new_capacity;
+  }
+
+  void Close() {
+    if (mapping_ != nullptr) {
+      munmap(mapping_, mapping_size_);
+      mapping_ = nullptr;
+    }
+    if (descriptor_ >= 0) {
+      close(descriptor_);
+      descriptor_ = -1;
+    }
+    mapping_size_ = 0;
+    capacity_ = 0;
+  }
+};
+
+#endif
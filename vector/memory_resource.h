@@ -0,0 +1,260 @@
+#ifndef MEMORY_RESOURCE_H_
+#define MEMORY_RESOURCE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Source of raw memory behind ResourceAllocator. Resources are not thread-safe and must outlive every allocator and
+// container that refers to them.
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    return DoAllocate(bytes, alignment);
+  }
+
+  void Deallocate(void* pointer, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    DoDeallocate(pointer, bytes, alignment);
+  }
+
+  bool IsEqual(const MemoryResource& other) const noexcept {
+    return this == &other;
+  }
+
+ private:
+  virtual void* DoAllocate(size_t bytes, size_t alignment) = 0;
+  virtual void DoDeallocate(void* pointer, size_t bytes, size_t alignment) = 0;
+};
+
+class NewDeleteResource : public MemoryResource {
+ private:
+  void* DoAllocate(size_t bytes, size_t alignment) override {
+    return operator new(bytes, std::align_val_t{alignment});
+  }
+
+  void DoDeallocate(void* pointer, size_t, size_t alignment) override {
+    operator delete(pointer, std::align_val_t{alignment});
+  }
+};
+
+inline MemoryResource* GetNewDeleteResource() {
+  static NewDeleteResource resource;
+  return &resource;
+}
+
+// Hands out memory by bumping a pointer through blocks obtained from upstream, each block twice as large as the
+// previous one. Deallocate does nothing; everything is returned at once by Release or the destructor, which suits
+// containers that live no longer than one request.
+class MonotonicArena : public MemoryResource {
+ public:
+  explicit MonotonicArena(size_t initial_size = 4096, MemoryResource* upstream = GetNewDeleteResource())
+      : upstream_{upstream}, next_size_{std::max(initial_size, sizeof(Block) + alignof(std::max_align_t))} {
+  }
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena() override {
+    Release();
+  }
+
+  void Release() {
+    while (blocks_ != nullptr) {
+      Block* previous = blocks_->previous;
+      upstream_->Deallocate(blocks_, blocks_->size, alignof(Block));
+      blocks_ = previous;
+    }
+    current_ = nullptr;
+    left_ = 0;
+  }
+
+  // Total size of the blocks obtained from upstream.
+  size_t Reserved() const {
+    size_t reserved = 0;
+    for (Block* block = blocks_; block != nullptr; block = block->previous) {
+      reserved += block->size;
+    }
+    return reserved;
+  }
+
+ private:
+  struct Block {
+    Block* previous;
+    size_t size;
+  };
+
+  MemoryResource* upstream_;
+  Block* blocks_ = nullptr;
+  void* current_ = nullptr;
+  size_t left_ = 0;
+  size_t next_size_;
+
+  void* DoAllocate(size_t bytes, size_t alignment) override {
+    if (current_ == nullptr || std::align(alignment, bytes, current_, left_) == nullptr) {
+      size_t size = std::max(next_size_, sizeof(Block) + bytes + alignment);
+      auto block = static_cast<Block*>(upstream_->Allocate(size, alignof(Block)));
+      block->previous = blocks_;
+      block->size = size;
+      blocks_ = block;
+      current_ = block + 1;
+      left_ = size - sizeof(Block);
+      next_size_ = size * 2;
+      std::align(alignment, bytes, current_, left_);
+    }
+    void* result = current_;
+    current_ = static_cast<char*>(current_) + bytes;
+    left_ -= bytes;
+    return result;
+  }
+
+  void DoDeallocate(void*, size_t, size_t) override {
+  }
+};
+
+// Segregated free lists for power-of-two size classes from kMinClass to kMaxClass bytes. Each class is refilled with
+// a chunk of kChunkSize bytes from upstream and freed blocks go back to their class list, so repeated allocations of
+// similar sizes never reach upstream after warm-up. Larger or over-aligned requests are passed to upstream directly.
+class SizeClassPool : public MemoryResource {
+ public:
+  static constexpr size_t kMinClass = 16;
+  static constexpr size_t kMaxClass = 4096;
+  static constexpr size_t kClasses = 9;
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  explicit SizeClassPool(MemoryResource* upstream = GetNewDeleteResource()) : upstream_{upstream} {
+  }
+
+  SizeClassPool(const SizeClassPool&) = delete;
+  SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+  ~SizeClassPool() override {
+    Release();
+  }
+
+  // Returns all chunks to upstream, invalidating every block handed out by the pool.
+  void Release() {
+    while (chunks_ != nullptr) {
+      Chunk* next = chunks_->next;
+      upstream_->Deallocate(chunks_, kChunkSize, alignof(std::max_align_t));
+      chunks_ = next;
+    }
+    std::fill_n(free_lists_, kClasses, nullptr);
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct Chunk {
+    Chunk* next;
+  };
+
+  MemoryResource* upstream_;
+  FreeBlock* free_lists_[kClasses] = {};
+  Chunk* chunks_ = nullptr;
+
+  static size_t GetClass(size_t bytes) {
+    size_t index = 0;
+    for (size_t size = kMinClass; size < bytes; size <<= 1) {
+      index++;
+    }
+    return index;
+  }
+
+  static bool IsPooled(size_t bytes, size_t alignment) {
+    return bytes <= kMaxClass && alignment <= alignof(std::max_align_t);
+  }
+
+  void Refill(size_t index) {
+    auto chunk = static_cast<Chunk*>(upstream_->Allocate(kChunkSize, alignof(std::max_align_t)));
+    chunk->next = chunks_;
+    chunks_ = chunk;
+    const size_t size = kMinClass << index;
+    char* begin = reinterpret_cast<char*>(chunk) + std::max(sizeof(Chunk), alignof(std::max_align_t));
+    char* end = reinterpret_cast<char*>(chunk) + kChunkSize;
+    for (char* block = begin; block + size <= end; block += size) {
+      auto free_block = reinterpret_cast<FreeBlock*>(block);
+      free_block->next = free_lists_[index];
+      free_lists_[index] = free_block;
+    }
+  }
+
+  void* DoAllocate(size_t bytes, size_t alignment) override {
+    if (!IsPooled(bytes, alignment)) {
+      return upstream_->Allocate(bytes, alignment);
+    }
+    const size_t index = GetClass(bytes);
+    if (free_lists_[index] == nullptr) {
+      Refill(index);
+    }
+    FreeBlock* block = free_lists_[index];
+    free_lists_[index] = block->next;
+    return block;
+  }
+
+  void DoDeallocate(void* pointer, size_t bytes, size_t alignment) override {
+    if (!IsPooled(bytes, alignment)) {
+      upstream_->Deallocate(pointer, bytes, alignment);
+      return;
+    }
+    const size_t index = GetClass(bytes);
+    auto block = static_cast<FreeBlock*>(pointer);
+    block->next = free_lists_[index];
+    free_lists_[index] = block;
+  }
+};
+
+// Allocator handle for Vector and other allocator-aware containers. Copies of a container share the resource of the
+// original; assignment and swap never propagate it, so every container keeps the resource it was created with and
+// elements are moved between resources when the two sides differ.
+template <class T>
+class ResourceAllocator {
+ public:
+  using value_type = T;                                    // NOLINT
+  using propagate_on_container_copy_assignment = std::false_type;  // NOLINT
+  using propagate_on_container_move_assignment = std::false_type;  // NOLINT
+  using propagate_on_container_swap = std::false_type;             // NOLINT
+  using is_always_equal = std::false_type;                         // NOLINT
+
+  ResourceAllocator() noexcept : resource_{GetNewDeleteResource()} {
+  }
+
+  ResourceAllocator(MemoryResource* resource) noexcept : resource_{resource} {  // NOLINT
+  }
+
+  template <class U>
+  ResourceAllocator(const ResourceAllocator<U>& other) noexcept : resource_{other.GetResource()} {  // NOLINT
+  }
+
+  T* allocate(size_t count) {  // NOLINT
+    return static_cast<T*>(resource_->Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* pointer, size_t count) {  // NOLINT
+    resource_->Deallocate(pointer, count * sizeof(T), alignof(T));
+  }
+
+  MemoryResource* GetResource() const {
+    return resource_;
+  }
+
+ private:
+  MemoryResource* resource_;
+};
+
+template <class T, class U>
+bool operator==(const ResourceAllocator<T>& left, const ResourceAllocator<U>& right) {
+  return left.GetResource()->IsEqual(*right.GetResource());
+}
+
+template <class T, class U>
+bool operator!=(const ResourceAllocator<T>& left, const ResourceAllocator<U>& right) {
+  return !(left == right);
+}
+
+#endif
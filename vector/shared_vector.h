@@ -0,0 +1,242 @@
+#ifndef SHARED_VECTOR_H_
+#define SHARED_VECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+template <class T>
+class AtomicSharedVector;
+
+// Copy-on-write handle to an immutable Vector. Copies share the buffer under an atomic reference count, so copying
+// costs one increment however large the vector is; Mutable clones the buffer first if any other copy shares it. Copies
+// may be read and destroyed concurrently from any threads, but one SharedVector object is not to be mutated
+// concurrently with other uses of it.
+template <class T>
+class SharedVector {
+ public:
+  using ValueType = T;
+  using VectorType = Vector<T>;
+  using ConstPointer = const T*;
+  using ConstReference = const T&;
+  using SizeType = size_t;
+  using ConstIterator = ConstPointer;
+
+  SharedVector() = default;
+
+  explicit SharedVector(VectorType values) : block_{new Block(std::move(values))} {
+  }
+
+  SharedVector(const SharedVector& other) : block_{other.block_} {
+    Acquire(block_);
+  }
+
+  SharedVector(SharedVector&& other) noexcept : block_{other.block_} {
+    other.block_ = nullptr;
+  }
+
+  SharedVector& operator=(const SharedVector& other) {
+    Acquire(other.block_);
+    Release(block_);
+    block_ = other.block_;
+    return *this;
+  }
+
+  SharedVector& operator=(SharedVector&& other) noexcept {
+    if (this != &other) {
+      Release(block_);
+      block_ = other.block_;
+      other.block_ = nullptr;
+    }
+    return *this;
+  }
+
+  ~SharedVector() {
+    Release(block_);
+  }
+
+  // The shared contents; an empty vector when nothing was ever stored.
+  const VectorType& Get() const {
+    static const VectorType kEmpty;
+    return block_ == nullptr ? kEmpty : block_->values;
+  }
+
+  // Number of SharedVector objects and AtomicSharedVector slots sharing the buffer; 0 for an empty handle.
+  SizeType UseCount() const {
+    return block_ == nullptr ? 0 : block_->references.load(std::memory_order_acquire);
+  }
+
+  SizeType Size() const {
+    return Get().Size();
+  }
+
+  bool Empty() const {
+    return Get().Empty();
+  }
+
+  ConstReference operator[](SizeType index) const {
+    return Get()[index];
+  }
+
+  ConstReference At(SizeType index) const {
+    if (index < Size()) {
+      return Get()[index];
+    }
+    throw std::out_of_range("ConstReference At(SizeType)");
+  }
+
+  ConstPointer Data() const {
+    return Get().Data();
+  }
+
+  // The contents for modification, cloned first if the buffer is shared. The reference is valid until this handle is
+  // copied, assigned or destroyed; copies made after that do not see later changes through a reference kept from
+  // before.
+  VectorType& Mutable() {
+    if (block_ == nullptr) {
+      block_ = new Block(VectorType());
+    } else if (block_->references.load(std::memory_order_acquire) != 1) {
+      auto clone = new Block(block_->values);
+      Release(block_);
+      block_ = clone;
+    }
+    return block_->values;
+  }
+
+  void Swap(SharedVector& other) {
+    std::swap(block_, other.block_);
+  }
+
+  ConstIterator begin() const {  // NOLINT
+    return Get().begin();
+  }
+
+  ConstIterator cbegin() const {  // NOLINT
+    return Get().begin();
+  }
+
+  ConstIterator end() const {  // NOLINT
+    return Get().end();
+  }
+
+  ConstIterator cend() const {  // NOLINT
+    return Get().end();
+  }
+
+ private:
+  friend class AtomicSharedVector<T>;
+
+  struct Block {
+    std::atomic<SizeType> references{1};
+    std::atomic<bool> stored{false};
+    VectorType values;
+
+    explicit Block(VectorType values_param) : values(std::move(values_param)) {
+    }
+  };
+
+  Block* block_ = nullptr;
+
+  static void Acquire(Block* block) {
+    if (block != nullptr) {
+      block->references.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  static void Release(Block* block) {
+    if (block != nullptr && block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete block;
+    }
+  }
+};
+
+// Slot holding the current version of a SharedVector, which writers replace and readers load concurrently without
+// locks, e.g. a routing table hot-swapped under running requests. Load borrows the buffer by incrementing a count kept
+// in the upper 16 bits of the same word as the pointer (user space addresses on x86-64 and AArch64 Linux fit in 48
+// bits), takes a reference, then returns the borrow; a writer that replaces the pointer in between converts the
+// outstanding borrows into references, which the borrowing readers drop. A reader tells whether that happened by
+// whether the pointer changed, so a buffer is stored at most once: storing a vector whose buffer was stored before, or
+// an empty one, stores a fresh copy. At most 65535 loads may be in flight at once.
+template <class T>
+class AtomicSharedVector {
+  static_assert(sizeof(uintptr_t) == 8, "AtomicSharedVector packs a counter into 64-bit pointers");
+
+ public:
+  AtomicSharedVector() = default;
+
+  explicit AtomicSharedVector(SharedVector<T> value) : state_{Pack(value)} {
+  }
+
+  AtomicSharedVector(const AtomicSharedVector&) = delete;
+  AtomicSharedVector& operator=(const AtomicSharedVector&) = delete;
+
+  ~AtomicSharedVector() {
+    SharedVector<T>::Release(GetBlock(state_.load(std::memory_order_acquire)));
+  }
+
+  SharedVector<T> Load() const {
+    const uintptr_t state = state_.fetch_add(kBorrow, std::memory_order_acquire) + kBorrow;
+    Block* block = GetBlock(state);
+    SharedVector<T>::Acquire(block);
+    uintptr_t expected = state;
+    while (!state_.compare_exchange_weak(expected, expected - kBorrow, std::memory_order_release, std::memory_order_relaxed)) {
+      if (GetBlock(expected) != block) {
+        // Replaced: the writer turned the borrow into a reference.
+        SharedVector<T>::Release(block);
+        break;
+      }
+    }
+    SharedVector<T> result;
+    result.block_ = block;
+    return result;
+  }
+
+  void Store(SharedVector<T> value) {
+    Exchange(std::move(value));
+  }
+
+  SharedVector<T> Exchange(SharedVector<T> value) {
+    const uintptr_t state = state_.exchange(Pack(value), std::memory_order_acq_rel);
+    Block* block = GetBlock(state);
+    if (block != nullptr) {
+      block->references.fetch_add(state >> kPointerBits, std::memory_order_relaxed);
+    }
+    SharedVector<T> result;
+    result.block_ = block;
+    return result;
+  }
+
+ private:
+  using Block = typename SharedVector<T>::Block;
+  using VectorType = typename SharedVector<T>::VectorType;
+
+  static constexpr int kPointerBits = 48;
+  static constexpr uintptr_t kBorrow = uintptr_t{1} << kPointerBits;
+
+  mutable std::atomic<uintptr_t> state_{0};
+
+  // Takes over the reference of value.
+  static uintptr_t Pack(SharedVector<T>& value) {
+    if (value.block_ == nullptr || value.block_->stored.exchange(true, std::memory_order_relaxed)) {
+      SharedVector<T> copy(VectorType(value.Get()));
+      copy.block_->stored.store(true, std::memory_order_relaxed);
+      value.Swap(copy);
+    }
+    const auto pointer = reinterpret_cast<uintptr_t>(value.block_);
+    if (pointer >= kBorrow) {
+      throw std::logic_error("AtomicSharedVector requires 48-bit addresses");
+    }
+    value.block_ = nullptr;
+    return pointer;
+  }
+
+  static Block* GetBlock(uintptr_t state) {
+    return reinterpret_cast<Block*>(state & (kBorrow - 1));
+  }
+};
+
+#endif
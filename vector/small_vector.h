@@ -0,0 +1,785 @@
+#ifndef SMALL_VECTOR_H_
+#define SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// Vector with room for N elements inside the object: the heap is used only when the size exceeds N. Moving a
+// SmallVector steals its heap buffer, or relocates the elements when they are stored inline. Heap buffers come from
+// Allocator, which propagates as in Vector, and their capacities from the Growth policy.
+template <class T, size_t N, class Allocator = std::allocator<T>, class Growth = DefaultVectorGrowth<T>>
+class SmallVector : private VectorAllocatorHolder<Allocator> {
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+  static_assert(N > 0, "use Vector for vectors without inline storage");
+  static_assert(std::is_same_v<typename AllocatorTraits::value_type, T>, "Allocator::value_type must be T");
+  static_assert(std::is_same_v<typename AllocatorTraits::pointer, T*>, "fancy pointers are not supported");
+
+  template <class Iterator>
+  using IteratorCategory = typename std::iterator_traits<Iterator>::iterator_category;
+
+  template <class Iterator>
+  static constexpr bool kIsForwardIterator = std::is_base_of_v<std::forward_iterator_tag, IteratorCategory<Iterator>>;
+
+ public:
+  using ValueType = T;
+  using AllocatorType = Allocator;
+  using GrowthType = Growth;
+  using Pointer = T*;
+  using ConstPointer = const T*;
+  using Reference = T&;
+  using ConstReference = const T&;
+  using SizeType = size_t;
+  using Iterator = Pointer;
+  using ConstIterator = ConstPointer;
+  using ReverseIterator = std::reverse_iterator<Iterator>;
+  using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+  static constexpr SizeType kInlineCapacity = N;
+
+  SmallVector() = default;
+
+  explicit SmallVector(const Allocator& allocator) : VectorAllocatorHolder<Allocator>(allocator) {
+  }
+
+  SmallVector(const SmallVector& other) : VectorAllocatorHolder<Allocator>(AllocatorTraits::select_on_container_copy_construction(other.GetAllocatorReference())) {
+    AppendCopies(other.buffer_, other.size_);
+  }
+
+  SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<ValueType> || IsTriviallyRelocatable<ValueType>::value)
+      : VectorAllocatorHolder<Allocator>(other.GetAllocatorReference()) {
+    TakeFrom(other);
+  }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this == &other) {
+      return *this;
+    }
+    constexpr bool kPropagate = AllocatorTraits::propagate_on_container_copy_assignment::value;
+    SmallVector copy(kPropagate ? other.GetAllocatorReference() : this->GetAllocatorReference());
+    copy.AppendCopies(other.buffer_, other.size_);
+    Release();
+    if constexpr (kPropagate) {
+      this->GetAllocatorReference() = other.GetAllocatorReference();
+    }
+    TakeFrom(copy);
+    return *this;
+  }
+
+  // Relocates the elements one by one into memory of this allocator when other's heap buffer cannot be taken over.
+  SmallVector& operator=(SmallVector&& other) noexcept((std::is_nothrow_move_constructible_v<ValueType> || IsTriviallyRelocatable<ValueType>::value) &&
+                                                       (AllocatorTraits::propagate_on_container_move_assignment::value || AllocatorTraits::is_always_equal::value)) {
+    if (this == &other) {
+      return *this;
+    }
+    Release();
+    if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value) {
+      this->GetAllocatorReference() = other.GetAllocatorReference();
+    }
+    TakeFrom(other);
+    return *this;
+  }
+
+  ~SmallVector() {
+    Release();
+  }
+
+  explicit SmallVector(SizeType new_size, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    Reserve(new_size);
+    try {
+      std::uninitialized_default_construct_n(buffer_, new_size);
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = new_size;
+  }
+
+  explicit SmallVector(SizeType new_size, const ValueType& value, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    Reserve(new_size);
+    try {
+      std::uninitialized_fill_n(buffer_, new_size, value);
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = new_size;
+  }
+
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::forward_iterator_tag, IteratorCategory<InputIterator>>>>
+  explicit SmallVector(InputIterator begin, InputIterator end, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    SizeType size = std::distance(begin, end);
+    Reserve(size);
+    try {
+      std::uninitialized_copy(begin, end, buffer_);
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = size;
+  }
+
+  SmallVector(const std::initializer_list<ValueType>& list, const Allocator& allocator = Allocator()) : SmallVector(list.begin(), list.end(), allocator) {
+  }
+
+  template <class VectorAllocator, class VectorGrowth>
+  explicit SmallVector(const Vector<ValueType, VectorAllocator, VectorGrowth>& other, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    AppendCopies(other.Data(), other.Size());
+  }
+
+  template <class VectorAllocator, class VectorGrowth>
+  explicit SmallVector(Vector<ValueType, VectorAllocator, VectorGrowth>&& other, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    Reserve(other.Size());
+    try {
+      std::uninitialized_move_n(other.Data(), other.Size(), buffer_);
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = other.Size();
+    other.Clear();
+  }
+
+  // The Vector shares the allocator and growth policy of this vector and is built in one allocation.
+  Vector<ValueType, Allocator, Growth> ToVector() const& {
+    return Vector<ValueType, Allocator, Growth>(begin(), end(), this->GetAllocatorReference());
+  }
+
+  Vector<ValueType, Allocator, Growth> ToVector() && {
+    Vector<ValueType, Allocator, Growth> result(std::make_move_iterator(begin()), std::make_move_iterator(end()), this->GetAllocatorReference());
+    Clear();
+    return result;
+  }
+
+  AllocatorType GetAllocator() const {
+    return this->GetAllocatorReference();
+  }
+
+  SizeType Size() const {
+    return size_;
+  }
+
+  SizeType Capacity() const {
+    return capacity_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  bool IsInline() const {
+    return buffer_ == GetInline();
+  }
+
+  Reference operator[](SizeType index) {
+    return buffer_[index];
+  }
+
+  ConstReference operator[](SizeType index) const {
+    return buffer_[index];
+  }
+
+  Reference At(SizeType index) {
+    if (index < size_) {
+      return buffer_[index];
+    }
+    throw std::out_of_range("Reference At(SizeType)");
+  }
+
+  ConstReference At(SizeType index) const {
+    if (index < size_) {
+      return buffer_[index];
+    }
+    throw std::out_of_range("ConstReference At(SizeType)");
+  }
+
+  Reference Front() {
+    if (size_ > 0) {
+      return buffer_[0];
+    }
+    throw std::out_of_range("Reference Front()");
+  }
+
+  ConstReference Front() const {
+    if (size_ > 0) {
+      return buffer_[0];
+    }
+    throw std::out_of_range("ConstReference Front()");
+  }
+
+  Reference Back() {
+    if (size_ > 0) {
+      return buffer_[size_ - 1];
+    }
+    throw std::out_of_range("Reference Back()");
+  }
+
+  ConstReference Back() const {
+    if (size_ > 0) {
+      return buffer_[size_ - 1];
+    }
+    throw std::out_of_range("ConstReference Back()");
+  }
+
+  Pointer Data() {
+    return buffer_;
+  }
+
+  ConstPointer Data() const {
+    return buffer_;
+  }
+
+  // Exchanges heap buffers when both vectors have one and the allocators allow it, otherwise relocates the elements.
+  void Swap(SmallVector& other) {
+    constexpr bool kPropagate = AllocatorTraits::propagate_on_container_swap::value;
+    if (!IsInline() && !other.IsInline() && (kPropagate || this->GetAllocatorReference() == other.GetAllocatorReference())) {
+      if constexpr (kPropagate) {
+        std::swap(this->GetAllocatorReference(), other.GetAllocatorReference());
+      }
+      std::swap(buffer_, other.buffer_);
+      std::swap(size_, other.size_);
+      std::swap(capacity_, other.capacity_);
+      return;
+    }
+    SmallVector temporary(std::move(other));
+    if constexpr (kPropagate) {
+      other.GetAllocatorReference() = this->GetAllocatorReference();
+    }
+    other.TakeFrom(*this);
+    if constexpr (kPropagate) {
+      this->GetAllocatorReference() = temporary.GetAllocatorReference();
+    }
+    TakeFrom(temporary);
+  }
+
+  void Resize(SizeType new_size) {
+    if (new_size <= size_) {
+      std::destroy_n(buffer_ + new_size, size_ - new_size);
+      size_ = new_size;
+      return;
+    }
+    if (new_size <= capacity_) {
+      std::uninitialized_default_construct_n(buffer_ + size_, new_size - size_);
+      size_ = new_size;
+      return;
+    }
+    const SizeType new_capacity = GrowCapacity(new_size);
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      std::uninitialized_default_construct_n(new_buffer + size_, new_size - size_);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_n(new_buffer + size_, new_size - size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    size_ = new_size;
+  }
+
+  void Resize(SizeType new_size, const ValueType& value) {
+    if (new_size <= size_) {
+      std::destroy_n(buffer_ + new_size, size_ - new_size);
+      size_ = new_size;
+      return;
+    }
+    if (new_size <= capacity_) {
+      std::uninitialized_fill_n(buffer_ + size_, new_size - size_, value);
+      size_ = new_size;
+      return;
+    }
+    const SizeType new_capacity = GrowCapacity(new_size);
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      std::uninitialized_fill_n(new_buffer + size_, new_size - size_, value);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_n(new_buffer + size_, new_size - size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    size_ = new_size;
+  }
+
+  void Reserve(SizeType new_capacity) {
+    if (new_capacity <= capacity_) {
+      return;
+    }
+    new_capacity = FitCapacity(new_capacity);
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+  }
+
+  // Moves the elements back inline when they fit, otherwise shrinks the heap buffer to the capacity the growth policy
+  // gives for the size.
+  void ShrinkToFit() {
+    if (IsInline() || size_ == capacity_) {
+      return;
+    }
+    if (size_ <= N) {
+      MoveBuffer(GetInline(), N);
+      return;
+    }
+    const SizeType new_capacity = FitCapacity(size_);
+    if (new_capacity >= capacity_) {
+      return;
+    }
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+  }
+
+  void Clear() {
+    std::destroy_n(buffer_, size_);
+    size_ = 0;
+  }
+
+  void PushBack(const ValueType& value) {
+    EmplaceBack(value);
+  }
+
+  void PushBack(ValueType&& value) {
+    EmplaceBack(std::move(value));
+  }
+
+  // The new element is constructed before the old ones are moved, so arguments may refer to elements of the vector.
+  template <class... Args>
+  Reference EmplaceBack(Args&&... args) {
+    if (size_ < capacity_) {
+      new (buffer_ + size_) ValueType(std::forward<Args>(args)...);
+      return buffer_[size_++];
+    }
+    const SizeType new_capacity = GrowCapacity(size_ + 1);
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      new (new_buffer + size_) ValueType(std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_at(new_buffer + size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    return buffer_[size_++];
+  }
+
+  void PopBack() {
+    if (size_ == 0) {
+      throw std::out_of_range("PopBack()");
+    }
+    size_--;
+    std::destroy_at(buffer_ + size_);
+  }
+
+  // Inserts an element constructed from args before position. It is constructed in the free slot past the end and
+  // rotated into place, or straight into its place in a new buffer, so the arguments may refer to elements.
+  template <class... Args>
+  Iterator Emplace(ConstIterator position, Args&&... args) {
+    const SizeType index = position - buffer_;
+    if (size_ == capacity_) {
+      const SizeType new_capacity = GrowCapacity(size_ + 1);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        new (new_buffer + index) ValueType(std::forward<Args>(args)...);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      try {
+        MoveBuffer(new_buffer, new_capacity, index, 1);
+      } catch (...) {
+        std::destroy_at(new_buffer + index);
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      size_++;
+      return buffer_ + index;
+    }
+    new (buffer_ + size_) ValueType(std::forward<Args>(args)...);
+    size_++;
+    RotateTail(index, size_ - 1);
+    return buffer_ + index;
+  }
+
+  // Appends copies of [first, last) with at most one reallocation. first and last may point into the vector.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  void Append(InputIterator first, InputIterator last) {
+    Insert(end(), first, last);
+  }
+
+  // Inserts copies of [first, last) before position. Forward ranges are counted and constructed past the end, or in
+  // a buffer that already has room for them, and rotated into place; input ranges are appended one by one first.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  Iterator Insert(ConstIterator position, InputIterator first, InputIterator last) {
+    const SizeType index = position - buffer_;
+    if constexpr (kIsForwardIterator<InputIterator>) {
+      const SizeType count = std::distance(first, last);
+      if (count > 0) {
+        InsertWith(index, count, [&](Pointer destination) { std::uninitialized_copy(first, last, destination); });
+      }
+    } else {
+      const SizeType old_size = size_;
+      try {
+        for (; first != last; ++first) {
+          EmplaceBack(*first);
+        }
+      } catch (...) {
+        std::destroy_n(buffer_ + old_size, size_ - old_size);
+        size_ = old_size;
+        throw;
+      }
+      RotateTail(index, old_size);
+    }
+    return buffer_ + index;
+  }
+
+  Iterator Insert(ConstIterator position, SizeType count, const ValueType& value) {
+    const SizeType index = position - buffer_;
+    if (count > 0) {
+      InsertWith(index, count, [&](Pointer destination) { std::uninitialized_fill_n(destination, count, value); });
+    }
+    return buffer_ + index;
+  }
+
+  Iterator Insert(ConstIterator position, std::initializer_list<ValueType> list) {
+    return Insert(position, list.begin(), list.end());
+  }
+
+  // Replaces the contents with copies of [first, last), reusing the buffer when it is large enough.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  void Assign(InputIterator first, InputIterator last) {
+    if constexpr (!kIsForwardIterator<InputIterator>) {
+      Clear();
+      Append(first, last);
+      return;
+    }
+    const SizeType count = std::distance(first, last);
+    if (count > capacity_) {
+      const SizeType new_capacity = FitCapacity(count);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        std::uninitialized_copy(first, last, new_buffer);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      Release();
+      buffer_ = new_buffer;
+      size_ = count;
+      capacity_ = new_capacity;
+      return;
+    }
+    if (count <= size_) {
+      // A subrange of the vector itself is never behind its destination, so the forward copy is safe.
+      std::copy(first, last, buffer_);
+      std::destroy_n(buffer_ + count, size_ - count);
+    } else {
+      auto middle = std::next(first, size_);
+      std::copy(first, middle, buffer_);
+      std::uninitialized_copy(middle, last, buffer_ + size_);
+    }
+    size_ = count;
+  }
+
+  void Assign(SizeType count, const ValueType& value) {
+    if (count > capacity_) {
+      const SizeType new_capacity = FitCapacity(count);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        std::uninitialized_fill_n(new_buffer, count, value);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      Release();
+      buffer_ = new_buffer;
+      size_ = count;
+      capacity_ = new_capacity;
+      return;
+    }
+    if (count <= size_) {
+      std::fill_n(buffer_, count, value);
+      std::destroy_n(buffer_ + count, size_ - count);
+    } else {
+      std::fill_n(buffer_, size_, value);
+      std::uninitialized_fill_n(buffer_ + size_, count - size_, value);
+    }
+    size_ = count;
+  }
+
+  void Assign(std::initializer_list<ValueType> list) {
+    Assign(list.begin(), list.end());
+  }
+
+  Iterator begin() {  // NOLINT
+    return buffer_;
+  }
+
+  ConstIterator begin() const {  // NOLINT
+    return buffer_;
+  }
+
+  ConstIterator cbegin() const {  // NOLINT
+    return buffer_;
+  }
+
+  Iterator end() {  // NOLINT
+    return buffer_ + size_;
+  }
+
+  ConstIterator end() const {  // NOLINT
+    return buffer_ + size_;
+  }
+
+  ConstIterator cend() const {  // NOLINT
+    return buffer_ + size_;
+  }
+
+  ReverseIterator rbegin() {  // NOLINT
+    return ReverseIterator(end());
+  }
+
+  ConstReverseIterator rbegin() const {  // NOLINT
+    return ConstReverseIterator(end());
+  }
+
+  ConstReverseIterator crbegin() const {  // NOLINT
+    return ConstReverseIterator(end());
+  }
+
+  ReverseIterator rend() {  // NOLINT
+    return ReverseIterator(begin());
+  }
+
+  ConstReverseIterator rend() const {  // NOLINT
+    return ConstReverseIterator(begin());
+  }
+
+  ConstReverseIterator crend() const {  // NOLINT
+    return ConstReverseIterator(begin());
+  }
+
+ private:
+  alignas(ValueType) unsigned char inline_[N * sizeof(ValueType)];
+  Pointer buffer_{GetInline()};
+  SizeType size_{0}, capacity_{N};
+
+  Pointer GetInline() {
+    return reinterpret_cast<Pointer>(inline_);
+  }
+
+  ConstPointer GetInline() const {
+    return reinterpret_cast<ConstPointer>(inline_);
+  }
+
+  Pointer Allocate(SizeType capacity) {
+    return AllocatorTraits::allocate(this->GetAllocatorReference(), capacity);
+  }
+
+  void Deallocate(Pointer buffer, SizeType capacity) {
+    AllocatorTraits::deallocate(this->GetAllocatorReference(), buffer, capacity);
+  }
+
+  SizeType GrowCapacity(SizeType required) const {
+    return Growth::Grow(capacity_, required, sizeof(ValueType));
+  }
+
+  static SizeType FitCapacity(SizeType required) {
+    return Growth::Fit(required, sizeof(ValueType));
+  }
+
+  // Moves size elements from source to the uninitialized destination and destroys the originals.
+  static void Relocate(Pointer source, SizeType size, Pointer destination) {
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      if (size > 0) {
+        std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), size * sizeof(ValueType));
+      }
+    } else {
+      std::uninitialized_move_n(source, size, destination);
+      std::destroy_n(source, size);
+    }
+  }
+
+  // Relocates the elements into new_buffer (the inline storage or a fresh heap buffer) and frees the old heap buffer.
+  void MoveBuffer(Pointer new_buffer, SizeType new_capacity) {
+    MoveBuffer(new_buffer, new_capacity, size_, 0);
+  }
+
+  // The same, leaving a gap of gap_size elements before the element at index gap. If a move constructor throws,
+  // nothing changes except that some elements may have been moved from.
+  void MoveBuffer(Pointer new_buffer, SizeType new_capacity, SizeType gap, SizeType gap_size) {
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      Relocate(buffer_, gap, new_buffer);
+      Relocate(buffer_ + gap, size_ - gap, new_buffer + gap + gap_size);
+    } else {
+      std::uninitialized_move_n(buffer_, gap, new_buffer);
+      try {
+        std::uninitialized_move_n(buffer_ + gap, size_ - gap, new_buffer + gap + gap_size);
+      } catch (...) {
+        std::destroy_n(new_buffer, gap);
+        throw;
+      }
+      std::destroy_n(buffer_, size_);
+    }
+    if (!IsInline()) {
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+  }
+
+  // Inserts count elements before index, constructed in uninitialized memory by construct(destination), which may
+  // read elements of the vector: they stay in place until it returns.
+  template <class Construct>
+  void InsertWith(SizeType index, SizeType count, Construct construct) {
+    const SizeType new_size = size_ + count;
+    if (new_size > capacity_) {
+      const SizeType new_capacity = GrowCapacity(new_size);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        construct(new_buffer + index);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      try {
+        MoveBuffer(new_buffer, new_capacity, index, count);
+      } catch (...) {
+        std::destroy_n(new_buffer + index, count);
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      size_ = new_size;
+      return;
+    }
+    construct(buffer_ + size_);
+    const SizeType old_size = size_;
+    size_ = new_size;
+    RotateTail(index, old_size);
+  }
+
+  // Moves the elements [old_size, size_) before index.
+  void RotateTail(SizeType index, SizeType old_size) {
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      auto bytes = reinterpret_cast<unsigned char*>(buffer_);
+      std::rotate(bytes + index * sizeof(ValueType), bytes + old_size * sizeof(ValueType), bytes + size_ * sizeof(ValueType));
+    } else {
+      std::rotate(buffer_ + index, buffer_ + old_size, buffer_ + size_);
+    }
+  }
+
+  // Constructor helper: fills the empty vector with copies, freeing the heap buffer if a copy throws.
+  void AppendCopies(ConstPointer source, SizeType size) {
+    Reserve(size);
+    try {
+      std::uninitialized_copy_n(source, size, buffer_);
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = size;
+  }
+
+  // Requires this to be empty and inline. Takes over the heap buffer of other when the allocators are equal, otherwise
+  // relocates the elements, into memory from this allocator if they do not fit inline.
+  void TakeFrom(SmallVector& other) {
+    if (!other.IsInline() && this->GetAllocatorReference() == other.GetAllocatorReference()) {
+      buffer_ = other.buffer_;
+      size_ = other.size_;
+      capacity_ = other.capacity_;
+      other.buffer_ = other.GetInline();
+      other.size_ = 0;
+      other.capacity_ = N;
+      return;
+    }
+    Reserve(other.size_);
+    Relocate(other.buffer_, other.size_, buffer_);
+    size_ = other.size_;
+    other.size_ = 0;
+    other.Release();
+  }
+
+  void Release() {
+    std::destroy_n(buffer_, size_);
+    if (!IsInline()) {
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = GetInline();
+    size_ = 0;
+    capacity_ = N;
+  }
+};
+
+template <class T, size_t N, class Growth>
+struct IsParallelConstructible<SmallVector<T, N, std::allocator<T>, Growth>> : IsParallelConstructible<T> {};
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+int8_t Compare(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return CompareVectorElements(left.Data(), left.Size(), right.Data(), right.Size());
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool Equal(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return EqualVectorElements(left.Data(), left.Size(), right.Data(), right.Size());
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator<(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return Compare(left, right) < 0;
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator>(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return Compare(left, right) > 0;
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator<=(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return Compare(left, right) <= 0;
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator>=(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return Compare(left, right) >= 0;
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator==(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return Equal(left, right);
+}
+
+template <class ValueType, size_t N, class Allocator, class Growth>
+bool operator!=(const SmallVector<ValueType, N, Allocator, Growth>& left, const SmallVector<ValueType, N, Allocator, Growth>& right) {
+  return !Equal(left, right);
+}
+
+#endif
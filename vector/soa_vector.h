@@ -0,0 +1,508 @@
+#ifndef SOA_VECTOR_H_
+#define SOA_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// Contiguous view of one column of a SoaVector, valid until the vector reallocates.
+template <class T>
+class SoaColumn {
+ public:
+  using ValueType = std::remove_const_t<T>;
+  using Pointer = T*;
+  using Reference = T&;
+  using SizeType = size_t;
+  using Iterator = Pointer;
+
+  SoaColumn(Pointer data, SizeType size) : data_{data}, size_{size} {
+  }
+
+  SizeType Size() const {
+    return size_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  Reference operator[](SizeType index) const {
+    return data_[index];
+  }
+
+  Pointer Data() const {
+    return data_;
+  }
+
+  Iterator begin() const {  // NOLINT
+    return data_;
+  }
+
+  Iterator end() const {  // NOLINT
+    return data_ + size_;
+  }
+
+ private:
+  Pointer data_;
+  SizeType size_;
+};
+
+// Vector of rows with fields Ts... stored as a structure of arrays: every field lives in its own contiguous column, so
+// a loop over a few fields reads only their columns. The columns share one allocation, one size and one capacity, each
+// column starting on a cache line. Capacities come from DefaultVectorGrowth<std::tuple<Ts...>> with the row size as
+// the element size. Rows are read and written through tuples of references, which structured bindings unpack.
+template <class... Ts>
+class SoaVector {
+  static_assert(sizeof...(Ts) > 0, "SoaVector needs at least one column");
+
+ public:
+  using ValueType = std::tuple<Ts...>;
+  using Reference = std::tuple<Ts&...>;
+  using ConstReference = std::tuple<const Ts&...>;
+  using SizeType = size_t;
+  using GrowthType = DefaultVectorGrowth<ValueType>;
+
+  template <size_t I>
+  using ColumnType = std::tuple_element_t<I, ValueType>;
+
+  static constexpr size_t kColumnCount = sizeof...(Ts);
+  static constexpr size_t kColumnAlignment = std::max({size_t{64}, alignof(Ts)...});
+
+  template <class Owner, class Row>
+  class RowIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;  // NOLINT
+    using value_type = ValueType;                       // NOLINT
+    using difference_type = ptrdiff_t;                  // NOLINT
+    using pointer = void;                               // NOLINT
+    using reference = Row;                              // NOLINT
+
+    RowIterator(Owner* owner, SizeType index) : owner_{owner}, index_{index} {
+    }
+
+    Row operator*() const {
+      return (*owner_)[index_];
+    }
+
+    RowIterator& operator++() {
+      index_++;
+      return *this;
+    }
+
+    RowIterator operator++(int) {
+      RowIterator result = *this;
+      index_++;
+      return result;
+    }
+
+    bool operator==(const RowIterator& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const RowIterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    Owner* owner_;
+    SizeType index_;
+  };
+
+  using Iterator = RowIterator<SoaVector, Reference>;
+  using ConstIterator = RowIterator<const SoaVector, ConstReference>;
+
+  SoaVector() = default;
+
+  SoaVector(const SoaVector& other) {
+    if (other.size_ == 0) {
+      return;
+    }
+    Reserve(other.size_);
+    try {
+      ConstructRows(buffer_, capacity_, 0, other.size_, [&other](auto column, auto destination) {
+        constexpr size_t kColumn = decltype(column)::value;
+        std::uninitialized_copy_n(other.Data<kColumn>(), other.size_, destination);
+      });
+    } catch (...) {
+      Release();
+      throw;
+    }
+    size_ = other.size_;
+  }
+
+  SoaVector(SoaVector&& other) noexcept : buffer_{other.buffer_}, size_{other.size_}, capacity_{other.capacity_} {
+    other.buffer_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+
+  SoaVector& operator=(const SoaVector& other) {
+    if (this != &other) {
+      SoaVector copy(other);
+      Swap(copy);
+    }
+    return *this;
+  }
+
+  SoaVector& operator=(SoaVector&& other) noexcept {
+    if (this != &other) {
+      Release();
+      Swap(other);
+    }
+    return *this;
+  }
+
+  ~SoaVector() {
+    Release();
+  }
+
+  explicit SoaVector(SizeType new_size) {
+    Reserve(new_size);
+    try {
+      Resize(new_size);
+    } catch (...) {
+      Release();
+      throw;
+    }
+  }
+
+  SizeType Size() const {
+    return size_;
+  }
+
+  SizeType Capacity() const {
+    return capacity_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  Reference operator[](SizeType index) {
+    return GetRow<Reference>(this, index, std::index_sequence_for<Ts...>{});
+  }
+
+  ConstReference operator[](SizeType index) const {
+    return GetRow<ConstReference>(this, index, std::index_sequence_for<Ts...>{});
+  }
+
+  Reference At(SizeType index) {
+    if (index < size_) {
+      return (*this)[index];
+    }
+    throw std::out_of_range("Reference At(SizeType)");
+  }
+
+  ConstReference At(SizeType index) const {
+    if (index < size_) {
+      return (*this)[index];
+    }
+    throw std::out_of_range("ConstReference At(SizeType)");
+  }
+
+  // The column of field I, aligned to kColumnAlignment. Null while nothing is allocated.
+  template <size_t I>
+  ColumnType<I>* Data() {
+    return buffer_ == nullptr ? nullptr : GetColumn<I>(buffer_, capacity_);
+  }
+
+  template <size_t I>
+  const ColumnType<I>* Data() const {
+    return buffer_ == nullptr ? nullptr : GetColumn<I>(buffer_, capacity_);
+  }
+
+  template <size_t I>
+  SoaColumn<ColumnType<I>> Column() {
+    return {Data<I>(), size_};
+  }
+
+  template <size_t I>
+  SoaColumn<const ColumnType<I>> Column() const {
+    return {Data<I>(), size_};
+  }
+
+  void Swap(SoaVector& other) {
+    std::swap(buffer_, other.buffer_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+  // New rows are default-initialized.
+  void Resize(SizeType new_size) {
+    if (new_size <= size_) {
+      DestroyRows(buffer_, capacity_, new_size, size_ - new_size);
+      size_ = new_size;
+      return;
+    }
+    auto construct = [count = new_size - size_](auto, auto destination) {
+      std::uninitialized_default_construct_n(destination, count);
+    };
+    if (new_size <= capacity_) {
+      ConstructRows(buffer_, capacity_, size_, new_size - size_, construct);
+      size_ = new_size;
+      return;
+    }
+    GrowWith(GrowCapacity(new_size), new_size - size_, construct);
+    size_ = new_size;
+  }
+
+  void Reserve(SizeType new_capacity) {
+    if (new_capacity <= capacity_) {
+      return;
+    }
+    new_capacity = FitCapacity(new_capacity);
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+  }
+
+  void ShrinkToFit() {
+    if (size_ == 0) {
+      Release();
+      return;
+    }
+    const SizeType new_capacity = FitCapacity(size_);
+    if (new_capacity >= capacity_) {
+      return;
+    }
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+  }
+
+  void Clear() {
+    DestroyRows(buffer_, capacity_, 0, size_);
+    size_ = 0;
+  }
+
+  void PushBack(const Ts&... values) {
+    EmplaceBack(values...);
+  }
+
+  void PushBack(Ts&&... values) {
+    EmplaceBack(std::move(values)...);
+  }
+
+  // Takes one constructor argument per column. The new row is constructed before the old ones are moved, so arguments
+  // may refer to rows of the vector.
+  template <class... Args>
+  void EmplaceBack(Args&&... args) {
+    static_assert(sizeof...(Args) == kColumnCount, "EmplaceBack takes one argument per column");
+    auto arguments = std::forward_as_tuple(std::forward<Args>(args)...);
+    auto construct = [&arguments](auto column, auto destination) {
+      constexpr size_t kColumn = decltype(column)::value;
+      new (destination) ColumnType<kColumn>(std::get<kColumn>(std::move(arguments)));
+    };
+    if (size_ < capacity_) {
+      ConstructRows(buffer_, capacity_, size_, 1, construct);
+    } else {
+      GrowWith(GrowCapacity(size_ + 1), 1, construct);
+    }
+    size_++;
+  }
+
+  void PopBack() {
+    if (size_ == 0) {
+      throw std::out_of_range("PopBack()");
+    }
+    size_--;
+    DestroyRows(buffer_, capacity_, size_, 1);
+  }
+
+  Iterator begin() {  // NOLINT
+    return Iterator(this, 0);
+  }
+
+  ConstIterator begin() const {  // NOLINT
+    return ConstIterator(this, 0);
+  }
+
+  ConstIterator cbegin() const {  // NOLINT
+    return ConstIterator(this, 0);
+  }
+
+  Iterator end() {  // NOLINT
+    return Iterator(this, size_);
+  }
+
+  ConstIterator end() const {  // NOLINT
+    return ConstIterator(this, size_);
+  }
+
+  ConstIterator cend() const {  // NOLINT
+    return ConstIterator(this, size_);
+  }
+
+ private:
+  static constexpr size_t kRowSize = (sizeof(Ts) + ...);
+
+  unsigned char* buffer_ = nullptr;
+  SizeType size_ = 0;
+  SizeType capacity_ = 0;
+
+  SizeType GrowCapacity(SizeType required) const {
+    return GrowthType::Grow(capacity_, required, kRowSize);
+  }
+
+  static SizeType FitCapacity(SizeType required) {
+    return GrowthType::Fit(required, kRowSize);
+  }
+
+  // Column I starts where column I - 1 ends, rounded up to kColumnAlignment; GetColumnOffset<kColumnCount> is the
+  // size of the whole buffer.
+  template <size_t I>
+  static size_t GetColumnOffset(SizeType capacity) {
+    if constexpr (I == 0) {
+      return 0;
+    } else {
+      const size_t end = GetColumnOffset<I - 1>(capacity) + capacity * sizeof(ColumnType<I - 1>);
+      return (end + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment;
+    }
+  }
+
+  template <size_t I>
+  static ColumnType<I>* GetColumn(unsigned char* buffer, SizeType capacity) {
+    return reinterpret_cast<ColumnType<I>*>(buffer + GetColumnOffset<I>(capacity));
+  }
+
+  template <class Row, class Owner, size_t... I>
+  static Row GetRow(Owner* owner, SizeType index, std::index_sequence<I...>) {
+    return Row(GetColumn<I>(owner->buffer_, owner->capacity_)[index]...);
+  }
+
+  static unsigned char* Allocate(SizeType capacity) {
+    return static_cast<unsigned char*>(operator new(GetColumnOffset<kColumnCount>(capacity), std::align_val_t{kColumnAlignment}));
+  }
+
+  static void Deallocate(unsigned char* buffer, SizeType capacity) {
+    operator delete(buffer, GetColumnOffset<kColumnCount>(capacity), std::align_val_t{kColumnAlignment});
+  }
+
+  // Calls function(std::integral_constant<size_t, I>()) for every column I in order.
+  template <class Function>
+  static void ForEachColumn(Function function) {
+    ForEachColumn(function, std::index_sequence_for<Ts...>{});
+  }
+
+  template <class Function, size_t... I>
+  static void ForEachColumn(Function function, std::index_sequence<I...>) {
+    (function(std::integral_constant<size_t, I>{}), ...);
+  }
+
+  // Constructs the rows [index, index + count) with construct(column, pointer to the row index of that column), one
+  // column after another. If a column throws, the columns constructed before it are destroyed.
+  template <class Construct>
+  static void ConstructRows(unsigned char* buffer, SizeType capacity, SizeType index, SizeType count, Construct construct) {
+    size_t constructed = 0;
+    try {
+      ForEachColumn([&](auto column) {
+        construct(column, GetColumn<decltype(column)::value>(buffer, capacity) + index);
+        constructed++;
+      });
+    } catch (...) {
+      DestroyRows(buffer, capacity, index, count, constructed);
+      throw;
+    }
+  }
+
+  // Destroys the rows [index, index + count) in the first columns columns.
+  static void DestroyRows(unsigned char* buffer, SizeType capacity, SizeType index, SizeType count, size_t columns = kColumnCount) {
+    if (count == 0) {
+      return;
+    }
+    ForEachColumn([&](auto column) {
+      if (decltype(column)::value < columns) {
+        std::destroy_n(GetColumn<decltype(column)::value>(buffer, capacity) + index, count);
+      }
+    });
+  }
+
+  // Moves to a buffer of new_capacity, constructing count rows after the current ones with construct first.
+  template <class Construct>
+  void GrowWith(SizeType new_capacity, SizeType count, Construct construct) {
+    auto new_buffer = Allocate(new_capacity);
+    try {
+      ConstructRows(new_buffer, new_capacity, size_, count, construct);
+    } catch (...) {
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      DestroyRows(new_buffer, new_capacity, size_, count);
+      Deallocate(new_buffer, new_capacity);
+      throw;
+    }
+  }
+
+  // Relocates the rows into new_buffer and frees the old buffer. Columns that are not trivially relocatable are moved
+  // first, so that if a move constructor throws, nothing changes except that some elements may have been moved from;
+  // the others are copied with memcpy once nothing can fail.
+  void MoveBuffer(unsigned char* new_buffer, SizeType new_capacity) {
+    size_t moved = 0;
+    try {
+      ForEachColumn([&](auto column) {
+        constexpr size_t kColumn = decltype(column)::value;
+        if constexpr (!IsTriviallyRelocatable<ColumnType<kColumn>>::value) {
+          std::uninitialized_move_n(GetColumn<kColumn>(buffer_, capacity_), size_, GetColumn<kColumn>(new_buffer, new_capacity));
+        }
+        moved++;
+      });
+    } catch (...) {
+      ForEachColumn([&](auto column) {
+        constexpr size_t kColumn = decltype(column)::value;
+        if constexpr (!IsTriviallyRelocatable<ColumnType<kColumn>>::value) {
+          if (kColumn < moved) {
+            std::destroy_n(GetColumn<kColumn>(new_buffer, new_capacity), size_);
+          }
+        }
+      });
+      throw;
+    }
+    ForEachColumn([&](auto column) {
+      constexpr size_t kColumn = decltype(column)::value;
+      if constexpr (IsTriviallyRelocatable<ColumnType<kColumn>>::value) {
+        if (size_ > 0) {
+          std::memcpy(static_cast<void*>(GetColumn<kColumn>(new_buffer, new_capacity)), static_cast<const void*>(GetColumn<kColumn>(buffer_, capacity_)), size_ * sizeof(ColumnType<kColumn>));
+        }
+      } else {
+        std::destroy_n(GetColumn<kColumn>(buffer_, capacity_), size_);
+      }
+    });
+    if (buffer_ != nullptr) {
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+  }
+
+  void Release() {
+    if (buffer_ != nullptr) {
+      DestroyRows(buffer_, capacity_, 0, size_);
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+  }
+};
+
+#endif
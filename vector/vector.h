@@ -3,13 +3,549 @@
 
 #define VECTOR_MEMORY_IMPLEMENTED
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+template <class T>
+struct DefaultVectorGrowth;
+
+template <class T, class Allocator = std::allocator<T>, class Growth = DefaultVectorGrowth<T>>
+class Vector;
+
+// Types whose objects can be moved to another address by copying their bytes, with neither the move constructor nor
+// the destructor run. Vector relocates such elements with memcpy when it reallocates. Specialize for user types with
+// this property: no pointers into the object itself and no registration of the object's address elsewhere.
+template <class T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <class T>
+struct IsTriviallyRelocatable<std::allocator<T>> : std::true_type {};
+
+template <class T, class Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
+template <class T>
+struct IsTriviallyRelocatable<std::default_delete<T>> : std::true_type {};
+
+template <class T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <class T, class Allocator, class Growth>
+struct IsTriviallyRelocatable<Vector<T, Allocator, Growth>> : IsTriviallyRelocatable<Allocator> {};
+
+#ifdef _LIBCPP_VERSION
+// libc++ keeps short strings inline without a pointer to them; libstdc++ points into the object, so its strings are
+// relocated by moving.
+template <class Char, class Traits, class Allocator>
+struct IsTriviallyRelocatable<std::basic_string<Char, Traits, Allocator>> : IsTriviallyRelocatable<Allocator> {};
+#endif
+
+// Where Vector with std::allocator or AlignedAllocator keeps the buffer of a trivially relocatable T, chosen by the
+// buffer size alone: small buffers come from the allocator, medium ones from malloc and are grown with realloc, large
+// ones are anonymous mappings grown with mremap, so that the kernel moves page table entries instead of copying the
+// data and the peak memory stays close to the buffer size.
+enum class VectorStorage {
+  kAllocator,
+  kRealloc,
+  kMapped,
+};
+
+constexpr size_t kVectorReallocThreshold = 64 << 10;
+constexpr size_t kVectorMappedThreshold = 1 << 20;
+
+inline VectorStorage GetVectorStorage(size_t bytes) {
+  if (bytes < kVectorReallocThreshold) {
+    return VectorStorage::kAllocator;
+  }
+#ifdef __linux__
+  if (bytes >= kVectorMappedThreshold) {
+    return VectorStorage::kMapped;
+  }
+#endif
+  return VectorStorage::kRealloc;
+}
+
+#ifdef __linux__
+inline size_t GetVectorMappedSize(size_t bytes) {
+  static const size_t kPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+}
+#endif
+
+inline void* AllocateVectorStorage(size_t bytes) {
+  void* result = nullptr;
+#ifdef __linux__
+  if (GetVectorStorage(bytes) == VectorStorage::kMapped) {
+    result = mmap(nullptr, GetVectorMappedSize(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    return result;
+  }
+#endif
+  result = std::malloc(bytes);
+  if (result == nullptr) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+inline void DeallocateVectorStorage(void* pointer, size_t bytes) {
+#ifdef __linux__
+  if (GetVectorStorage(bytes) == VectorStorage::kMapped) {
+    munmap(pointer, GetVectorMappedSize(bytes));
+    return;
+  }
+#endif
+  std::free(pointer);
+}
+
+// Resizes storage of old_bytes obtained from AllocateVectorStorage to new_bytes of the same kind, keeping the contents.
+inline void* ReallocateVectorStorage(void* pointer, size_t old_bytes, size_t new_bytes) {
+  void* result = nullptr;
+#ifdef __linux__
+  if (GetVectorStorage(old_bytes) == VectorStorage::kMapped) {
+    result = mremap(pointer, GetVectorMappedSize(old_bytes), GetVectorMappedSize(new_bytes), MREMAP_MAYMOVE);
+    if (result == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    return result;
+  }
+#endif
+  result = std::realloc(pointer, new_bytes);
+  if (result == nullptr) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+// Growth policies choose the capacities Vector allocates. Grow gives the capacity when appending needs required
+// elements and the current capacity is exhausted; Fit gives it when the size is requested explicitly, by the sized
+// constructors, Reserve and ShrinkToFit. Both return at least required. A policy is chosen per vector by the Growth
+// template argument, and per element type by specializing DefaultVectorGrowth.
+struct DoublingGrowth {
+  static size_t Grow(size_t capacity, size_t required, size_t) {
+    return std::max(required, capacity * 2);
+  }
+
+  static size_t Fit(size_t required, size_t) {
+    return required;
+  }
+};
+
+// With a factor below the golden ratio the blocks freed by earlier reallocations eventually add up to the next request,
+// so an allocator that coalesces neighbouring blocks can reuse them.
+struct OneAndHalfGrowth {
+  static size_t Grow(size_t capacity, size_t required, size_t) {
+    return std::max(required, capacity + capacity / 2);
+  }
+
+  static size_t Fit(size_t required, size_t) {
+    return required;
+  }
+};
+
+// Rounds an allocation up to the size class that serves it: multiples of 16 bytes up to 128, then four classes per
+// power of two as in jemalloc (and close to glibc, whose bins are 16 bytes apart), and whole pages from
+// kVectorMappedThreshold, where both glibc and Vector's own storage map memory directly.
+inline size_t GetAllocationSizeClass(size_t bytes) {
+  if (bytes <= 128) {
+    return (bytes + 15) / 16 * 16;
+  }
+#ifdef __linux__
+  if (bytes >= kVectorMappedThreshold) {
+    return GetVectorMappedSize(bytes);
+  }
+#endif
+  size_t spacing = 32;
+  while (spacing * 8 < bytes) {
+    spacing *= 2;
+  }
+  return (bytes + spacing - 1) / spacing * spacing;
+}
+
+// Extends every capacity chosen by Base to fill its size class, so the slack the allocator hands out anyway becomes
+// usable capacity.
+template <class Base = OneAndHalfGrowth>
+struct SizeClassGrowth {
+  static size_t Grow(size_t capacity, size_t required, size_t element_size) {
+    return RoundUp(Base::Grow(capacity, required, element_size), element_size);
+  }
+
+  static size_t Fit(size_t required, size_t element_size) {
+    return RoundUp(Base::Fit(required, element_size), element_size);
+  }
+
+ private:
+  static size_t RoundUp(size_t count, size_t element_size) {
+    return GetAllocationSizeClass(count * element_size) / element_size;
+  }
+};
+
+template <class T>
+struct DefaultVectorGrowth : DoublingGrowth {};
+
+// Pads every capacity chosen by Base to a whole number of Width-byte blocks, so that SIMD kernels can load full
+// vectors up to Capacity() and handle the tail without a scalar loop. The padding elements are not part of the vector.
+template <size_t Width, class Base = DoublingGrowth>
+struct PaddedGrowth {
+  static size_t Grow(size_t capacity, size_t required, size_t element_size) {
+    return RoundUp(Base::Grow(capacity, required, element_size), element_size);
+  }
+
+  static size_t Fit(size_t required, size_t element_size) {
+    return RoundUp(Base::Fit(required, element_size), element_size);
+  }
+
+ private:
+  static size_t RoundUp(size_t count, size_t element_size) {
+    return (count * element_size + Width - 1) / Width * Width / element_size;
+  }
+};
+
+// Allocates with aligned operator new, so that the buffer starts on a cache line or at the alignment required by
+// aligned SIMD loads.
+template <class T, size_t Alignment = 64>
+class AlignedAllocator {
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two not below alignof(T)");
+
+ public:
+  using value_type = T;                    // NOLINT
+  using is_always_equal = std::true_type;  // NOLINT
+
+  template <class U>
+  struct rebind {  // NOLINT
+    using other = AlignedAllocator<U, Alignment>;  // NOLINT
+  };
+
+  static constexpr size_t kAlignment = Alignment;
+
+  AlignedAllocator() noexcept = default;
+
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {  // NOLINT
+  }
+
+  T* allocate(size_t count) {  // NOLINT
+    return static_cast<T*>(operator new(count * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T* pointer, size_t count) {  // NOLINT
+    operator delete(pointer, count * sizeof(T), std::align_val_t{Alignment});
+  }
+};
+
+template <class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+
+template <class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+
+// Vector on aligned storage with the capacity padded to whole Alignment-byte blocks.
+template <class T, size_t Alignment = 64>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, PaddedGrowth<Alignment>>;
+
+// Alignment of the memory an allocator returns, for the allocators whose memory Vector may replace by its own storage
+// tiers; 0 for the others.
+template <class Allocator>
+struct VectorStorageAlignment : std::integral_constant<size_t, 0> {};
+
+template <class T>
+struct VectorStorageAlignment<std::allocator<T>> : std::integral_constant<size_t, alignof(T)> {};
+
+template <class T, size_t Alignment>
+struct VectorStorageAlignment<AlignedAllocator<T, Alignment>> : std::integral_constant<size_t, Alignment> {};
+
+// Every page size Linux supports is a multiple of this, so mappings satisfy smaller alignments.
+constexpr size_t kVectorMappedAlignment = 4096;
+
+// Bulk construction, copying and destruction of at least kVectorParallelThreshold bytes of elements is split into
+// chunks of at least kVectorParallelChunk bytes, run by the workers of VectorWorkerPool. Chunk boundaries depend only on
+// the element count and fall on page boundaries of a mapped buffer, and chunk k always runs on worker k, which stays on
+// one CPU. So every bulk operation over a buffer touches each page from the same CPU: the first one to touch it makes
+// the kernel place it on that CPU's NUMA node, and the later ones find it there.
+constexpr size_t kVectorParallelThreshold = 16 << 20;
+constexpr size_t kVectorParallelChunk = 4 << 20;
+
+// Types whose constructors, copies and destructor may run on different objects at the same time from several threads,
+// so that Vector may split its bulk operations on them. Trivially copyable types qualify as their copies are memcpy;
+// other types are processed on the calling thread unless specialized, since their constructors or destructors may touch
+// shared state such as a memory resource that is not thread-safe.
 template <class T>
-class Vector {
+struct IsParallelConstructible : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+// The global heap is thread-safe, so strings and vectors that allocate from it qualify when their elements do.
+template <class Char, class Traits>
+struct IsParallelConstructible<std::basic_string<Char, Traits, std::allocator<Char>>> : std::true_type {};
+
+template <class T, class Growth>
+struct IsParallelConstructible<Vector<T, std::allocator<T>, Growth>> : IsParallelConstructible<T> {};
+
+template <class T, size_t Alignment, class Growth>
+struct IsParallelConstructible<Vector<T, AlignedAllocator<T, Alignment>, Growth>> : IsParallelConstructible<T> {};
+
+// Threads started on first use, one per CPU the process may run on, worker k pinned to the k-th of them on Linux. They
+// are never stopped, so that bulk operations run by destructors of static objects still find them.
+class VectorWorkerPool {
+ public:
+  // nullptr on a single CPU or if no thread could be started.
+  static VectorWorkerPool* Get() {
+    static VectorWorkerPool* pool = Create();
+    return pool;
+  }
+
+  size_t Size() const {
+    return workers_;
+  }
+
+  // Runs task(k) on worker k for every k below count, at most Size(), and waits for all of them; task must not throw.
+  // Returns false without running anything while another call is in progress, which includes calls from the tasks,
+  // and in a child process forked after the workers were started.
+  template <class Task>
+  bool Run(size_t count, const Task& task) {
+    std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+#ifdef __linux__
+    if (!run_lock.owns_lock() || getpid() != process_) {
+      return false;
+    }
+#else
+    if (!run_lock.owns_lock()) {
+      return false;
+    }
+#endif
+    std::unique_lock<std::mutex> lock(mutex_);
+    invoke_ = [](const void* erased, size_t index) { (*static_cast<const Task*>(erased))(index); };
+    task_ = &task;
+    count_ = count;
+    remaining_ = count;
+    generation_++;
+    start_.notify_all();
+    done_.wait(lock, [this] { return remaining_ == 0; });
+    return true;
+  }
+
+ private:
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  size_t workers_ = 0;
+  uint64_t generation_ = 0;
+  size_t count_ = 0;
+  size_t remaining_ = 0;
+  void (*invoke_)(const void*, size_t) = nullptr;
+  const void* task_ = nullptr;
+#ifdef __linux__
+  pid_t process_ = getpid();
+#endif
+
+  // The pool is leaked on purpose, see above.
+  static VectorWorkerPool* Create() {
+    auto pool = new (std::nothrow) VectorWorkerPool;
+    if (pool == nullptr) {
+      return nullptr;
+    }
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 1) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpus) && !pool->Start(cpu)) {
+          break;
+        }
+      }
+    }
+#else
+    for (size_t i = 0, threads = std::thread::hardware_concurrency(); i < threads && threads > 1; i++) {
+      if (!pool->Start(-1)) {
+        break;
+      }
+    }
+#endif
+    if (pool->workers_ < 2) {
+      // Started workers keep waiting for a generation that never comes.
+      return nullptr;
+    }
+    return pool;
+  }
+
+  // Starts worker workers_ on cpu, or on any CPU if cpu is negative.
+  bool Start(int cpu) {
+    try {
+      std::thread(&VectorWorkerPool::Work, this, workers_, cpu).detach();
+    } catch (...) {
+      return false;
+    }
+    workers_++;
+    return true;
+  }
+
+  void Work(size_t index, int cpu) {
+#ifdef __linux__
+    if (cpu >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu, &cpus);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#else
+    static_cast<void>(cpu);
+#endif
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      start_.wait(lock, [&] { return generation_ != seen; });
+      seen = generation_;
+      if (index >= count_) {
+        continue;
+      }
+      lock.unlock();
+      invoke_(task_, index);
+      lock.lock();
+      if (--remaining_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+};
+
+inline size_t GetVectorParallelChunks(size_t bytes) {
+  if (bytes < kVectorParallelThreshold) {
+    return 1;
+  }
+  VectorWorkerPool* pool = VectorWorkerPool::Get();
+  return pool == nullptr ? 1 : std::min(pool->Size(), bytes / kVectorParallelChunk);
+}
+
+// Calls process(begin, end) on chunks covering the indices [0, size) of elements of element_size bytes. Chunk k starts
+// at the first element that does not begin before byte k * step, step being a whole number of kVectorMappedAlignment
+// pages, so only an element straddling a page boundary puts that page in two chunks. A call that throws must leave its
+// chunk as it found it; rollback(begin, end) is then called for every chunk that was processed and the first exception
+// is rethrown. When the pool is busy or there is no memory to track the chunks, the whole range runs on the caller, so
+// that destruction never throws.
+template <class Process, class Rollback>
+void ForEachVectorChunk(size_t size, size_t element_size, Process process, Rollback rollback) {
+  const size_t bytes = size * element_size;
+  const size_t chunks = GetVectorParallelChunks(bytes);
+  if (chunks <= 1) {
+    if (size > 0) {
+      process(size_t{0}, size);
+    }
+    return;
+  }
+  const size_t step = ((bytes + chunks - 1) / chunks + kVectorMappedAlignment - 1) / kVectorMappedAlignment * kVectorMappedAlignment;
+  const size_t count = (bytes + step - 1) / step;
+  auto boundary = [size, element_size, step](size_t chunk) { return std::min(size, (chunk * step + element_size - 1) / element_size); };
+  std::unique_ptr<std::exception_ptr[]> errors(new (std::nothrow) std::exception_ptr[count]);
+  auto run = [&](size_t chunk) {
+    try {
+      process(boundary(chunk), boundary(chunk + 1));
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+  if (errors == nullptr || !VectorWorkerPool::Get()->Run(count, run)) {
+    process(size_t{0}, size);
+    return;
+  }
+  auto error = std::find_if(errors.get(), errors.get() + count, [](const std::exception_ptr& e) { return e != nullptr; });
+  if (error == errors.get() + count) {
+    return;
+  }
+  for (size_t chunk = 0; chunk < count; chunk++) {
+    if (errors[chunk] == nullptr) {
+      rollback(boundary(chunk), boundary(chunk + 1));
+    }
+  }
+  std::rethrow_exception(*error);
+}
+
+// Keeps an empty allocator out of the object layout.
+template <class Allocator, bool = std::is_empty_v<Allocator> && !std::is_final_v<Allocator>>
+class VectorAllocatorHolder : private Allocator {
+ protected:
+  VectorAllocatorHolder() = default;
+
+  explicit VectorAllocatorHolder(const Allocator& allocator) : Allocator(allocator) {
+  }
+
+  Allocator& GetAllocatorReference() {
+    return *this;
+  }
+
+  const Allocator& GetAllocatorReference() const {
+    return *this;
+  }
+};
+
+template <class Allocator>
+class VectorAllocatorHolder<Allocator, false> {
+ protected:
+  VectorAllocatorHolder() = default;
+
+  explicit VectorAllocatorHolder(const Allocator& allocator) : allocator_(allocator) {
+  }
+
+  Allocator& GetAllocatorReference() {
+    return allocator_;
+  }
+
+  const Allocator& GetAllocatorReference() const {
+    return allocator_;
+  }
+
+ private:
+  Allocator allocator_;
+};
+
+// All storage is obtained from Allocator; elements are constructed in place. Copy construction takes the allocator
+// from select_on_container_copy_construction, and assignment and Swap follow the propagate_on_container_* traits. When
+// a move assignment or Swap may not propagate and the allocators differ, elements are moved one by one into memory of
+// the receiving vector's allocator instead of exchanging buffers. Capacities are chosen by the Growth policy.
+template <class T, class Allocator, class Growth>
+class Vector : private VectorAllocatorHolder<Allocator> {
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+  static_assert(std::is_same_v<typename AllocatorTraits::value_type, T>, "Allocator::value_type must be T");
+  static_assert(std::is_same_v<typename AllocatorTraits::pointer, T*>, "fancy pointers are not supported");
+
+  static constexpr size_t kStorageAlignment = VectorStorageAlignment<Allocator>::value;
+  static constexpr bool kRemappable = kStorageAlignment != 0 && kStorageAlignment <= kVectorMappedAlignment && IsTriviallyRelocatable<T>::value;
+
+  template <class Iterator>
+  using IteratorCategory = typename std::iterator_traits<Iterator>::iterator_category;
+
+  template <class Iterator>
+  static constexpr bool kIsForwardIterator = std::is_base_of_v<std::forward_iterator_tag, IteratorCategory<Iterator>>;
+
  public:
   using ValueType = T;
+  using AllocatorType = Allocator;
+  using GrowthType = Growth;
   using Pointer = T*;
   using ConstPointer = const T*;
   using Reference = T&;
@@ -17,20 +553,23 @@ class Vector {
   using SizeType = size_t;
   using Iterator = Pointer;
   using ConstIterator = ConstPointer;
-  using ReverseIterator = std::reverse_iterator<Vector<ValueType>::Iterator>;
-  using ConstReverseIterator = std::reverse_iterator<Vector<ValueType>::ConstIterator>;
+  using ReverseIterator = std::reverse_iterator<Iterator>;
+  using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
 
   Vector() = default;
 
-  Vector(const Vector<ValueType>& other) {
+  explicit Vector(const Allocator& allocator) : VectorAllocatorHolder<Allocator>(allocator) {
+  }
+
+  Vector(const Vector& other) : VectorAllocatorHolder<Allocator>(AllocatorTraits::select_on_container_copy_construction(other.GetAllocatorReference())) {
     if (other.buffer_ == nullptr) {
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](other.capacity_ * sizeof(ValueType)));
+    auto new_buffer = Allocate(other.capacity_);
     try {
-      std::uninitialized_copy_n(other.buffer_, other.size_, new_buffer);
+      UninitializedCopy(other.buffer_, other.size_, new_buffer);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, other.capacity_);
       throw;
     }
     buffer_ = new_buffer;
@@ -38,50 +577,81 @@ class Vector {
     capacity_ = other.capacity_;
   }
 
-  Vector(Vector<ValueType>&& other) : buffer_{other.buffer_}, size_{other.size_}, capacity_{other.capacity_} {
+  Vector(Vector&& other) : VectorAllocatorHolder<Allocator>(other.GetAllocatorReference()), buffer_{other.buffer_}, size_{other.size_}, capacity_{other.capacity_} {
     other.buffer_ = nullptr;
     other.size_ = 0;
     other.capacity_ = 0;
   }
 
-  Vector& operator=(const Vector<ValueType>& other) {
+  // Takes over the buffer of other if the allocators are equal, otherwise moves the elements into memory from
+  // allocator.
+  Vector(Vector&& other, const Allocator& allocator) : VectorAllocatorHolder<Allocator>(allocator) {
+    if (allocator == other.GetAllocatorReference()) {
+      std::swap(buffer_, other.buffer_);
+      std::swap(size_, other.size_);
+      std::swap(capacity_, other.capacity_);
+      return;
+    }
+    if (other.buffer_ == nullptr) {
+      return;
+    }
+    auto new_buffer = Allocate(other.size_);
+    try {
+      std::uninitialized_move_n(other.buffer_, other.size_, new_buffer);
+    } catch (...) {
+      Deallocate(new_buffer, other.size_);
+      throw;
+    }
+    buffer_ = new_buffer;
+    size_ = other.size_;
+    capacity_ = other.size_;
+  }
+
+  Vector& operator=(const Vector& other) {
     if (this == &other) {
       return *this;
     }
-    if (other.buffer_ == nullptr) {
-      if (buffer_ != nullptr) {
-        std::destroy_n(buffer_, size_);
-        operator delete[](buffer_);
-        buffer_ = nullptr;
-        size_ = 0;
-        capacity_ = 0;
+    if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value) {
+      if (this->GetAllocatorReference() != other.GetAllocatorReference()) {
+        Release();
       }
+      this->GetAllocatorReference() = other.GetAllocatorReference();
+    }
+    if (other.buffer_ == nullptr) {
+      Release();
       return *this;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](other.capacity_ * sizeof(ValueType)));
+    auto new_buffer = Allocate(other.capacity_);
     try {
-      std::uninitialized_copy_n(other.buffer_, other.size_, new_buffer);
+      UninitializedCopy(other.buffer_, other.size_, new_buffer);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, other.capacity_);
       throw;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
-    }
+    Release();
     buffer_ = new_buffer;
     size_ = other.size_;
     capacity_ = other.capacity_;
     return *this;
   }
 
-  Vector& operator=(Vector<ValueType>&& other) noexcept {
+  Vector& operator=(Vector&& other) noexcept(AllocatorTraits::propagate_on_container_move_assignment::value || AllocatorTraits::is_always_equal::value) {
     if (this == &other) {
       return *this;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
+    if constexpr (!AllocatorTraits::propagate_on_container_move_assignment::value) {
+      if (this->GetAllocatorReference() != other.GetAllocatorReference()) {
+        Vector moved(std::move(other), this->GetAllocatorReference());
+        Release();
+        std::swap(buffer_, moved.buffer_);
+        std::swap(size_, moved.size_);
+        std::swap(capacity_, moved.capacity_);
+        return *this;
+      }
+    }
+    Release();
+    if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value) {
+      this->GetAllocatorReference() = other.GetAllocatorReference();
     }
     buffer_ = other.buffer_;
     size_ = other.size_;
@@ -93,65 +663,77 @@ class Vector {
   }
 
   ~Vector() {
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
-    }
-    buffer_ = nullptr;
-    size_ = 0;
-    capacity_ = 0;
+    Release();
   }
 
-  explicit Vector(SizeType new_size) {
+  explicit Vector(SizeType new_size, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
     if (new_size > 0) {
-      auto new_buffer = static_cast<Pointer>(operator new[](new_size * sizeof(ValueType)));
+      const SizeType capacity = FitCapacity(new_size);
+      auto new_buffer = Allocate(capacity);
       try {
-        std::uninitialized_default_construct_n(new_buffer, new_size);
+        UninitializedDefaultConstruct(new_buffer, new_size);
       } catch (...) {
-        operator delete[](new_buffer);
+        Deallocate(new_buffer, capacity);
         throw;
       }
       buffer_ = new_buffer;
       size_ = new_size;
-      capacity_ = new_size;
+      capacity_ = capacity;
     }
   }
 
-  explicit Vector(SizeType new_size, const ValueType& value) {
+  explicit Vector(SizeType new_size, const ValueType& value, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
     if (new_size > 0) {
-      auto new_buffer = static_cast<Pointer>(operator new[](new_size * sizeof(ValueType)));
+      const SizeType capacity = FitCapacity(new_size);
+      auto new_buffer = Allocate(capacity);
       try {
-        std::uninitialized_fill_n(new_buffer, new_size, value);
+        UninitializedFill(new_buffer, new_size, value);
       } catch (...) {
-        operator delete[](new_buffer);
+        Deallocate(new_buffer, capacity);
         throw;
       }
       buffer_ = new_buffer;
       size_ = new_size;
-      capacity_ = new_size;
+      capacity_ = capacity;
     }
   }
 
-  template <class Iterator, class = std::enable_if_t<std::is_base_of_v<
-                                std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>>>
-  explicit Vector(Iterator begin, Iterator end) {
-    SizeType size = end - begin;
+  // Single-pass input iterators are appended one by one.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  explicit Vector(InputIterator begin, InputIterator end, const Allocator& allocator = Allocator()) : VectorAllocatorHolder<Allocator>(allocator) {
+    if constexpr (!kIsForwardIterator<InputIterator>) {
+      try {
+        for (; begin != end; ++begin) {
+          EmplaceBack(*begin);
+        }
+      } catch (...) {
+        Release();
+        throw;
+      }
+      return;
+    }
+    SizeType size = std::distance(begin, end);
     if (size == 0) {
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](size * sizeof(ValueType)));
+    const SizeType capacity = FitCapacity(size);
+    auto new_buffer = Allocate(capacity);
     try {
       std::uninitialized_move_n(begin, size, new_buffer);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, capacity);
       throw;
     }
     buffer_ = new_buffer;
     size_ = size;
-    capacity_ = size;
+    capacity_ = capacity;
+  }
+
+  Vector(const std::initializer_list<ValueType>& list, const Allocator& allocator = Allocator()) : Vector(list.begin(), list.end(), allocator) {
   }
 
-  Vector(const std::initializer_list<ValueType>& list) : Vector(list.begin(), list.end()) {
+  AllocatorType GetAllocator() const {
+    return this->GetAllocatorReference();
   }
 
   SizeType Size() const {
@@ -224,7 +806,16 @@ class Vector {
     return buffer_;
   }
 
-  void Swap(Vector<ValueType>& other) {
+  void Swap(Vector& other) {
+    if constexpr (AllocatorTraits::propagate_on_container_swap::value) {
+      std::swap(this->GetAllocatorReference(), other.GetAllocatorReference());
+    } else if (this->GetAllocatorReference() != other.GetAllocatorReference()) {
+      Vector mine(std::move(other), this->GetAllocatorReference());
+      Vector theirs(std::move(*this), other.GetAllocatorReference());
+      *this = std::move(mine);
+      other = std::move(theirs);
+      return;
+    }
     std::swap(buffer_, other.buffer_);
     std::swap(size_, other.size_);
     std::swap(capacity_, other.capacity_);
@@ -236,7 +827,8 @@ class Vector {
       size_ = new_size;
       return;
     }
-    if (new_size <= capacity_) {
+    const SizeType new_capacity = new_size <= capacity_ ? capacity_ : GrowCapacity(new_size);
+    if (new_size <= capacity_ || Remap(new_capacity)) {
       try {
         std::uninitialized_default_construct_n(buffer_ + size_, new_size - size_);
       } catch (...) {
@@ -245,21 +837,21 @@ class Vector {
       size_ = new_size;
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](new_size * sizeof(ValueType)));
+    auto new_buffer = Allocate(new_capacity);
     try {
       std::uninitialized_default_construct_n(new_buffer + size_, new_size - size_);
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, new_capacity);
       throw;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_n(new_buffer + size_, new_size - size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
     }
-    buffer_ = new_buffer;
     size_ = new_size;
-    capacity_ = new_size;
   }
 
   void Resize(SizeType new_size, const ValueType& value) {
@@ -268,7 +860,8 @@ class Vector {
       size_ = new_size;
       return;
     }
-    if (new_size <= capacity_) {
+    const SizeType new_capacity = new_size <= capacity_ ? capacity_ : GrowCapacity(new_size);
+    if (new_size <= capacity_ || Remap(new_capacity, value)) {
       try {
         std::uninitialized_fill_n(buffer_ + size_, new_size - size_, value);
       } catch (...) {
@@ -277,134 +870,312 @@ class Vector {
       size_ = new_size;
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](new_size * sizeof(ValueType)));
+    auto new_buffer = Allocate(new_capacity);
     try {
       std::uninitialized_fill_n(new_buffer + size_, new_size - size_, value);
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, new_capacity);
       throw;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_n(new_buffer + size_, new_size - size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
     }
-    buffer_ = new_buffer;
     size_ = new_size;
-    capacity_ = new_size;
+  }
+
+  // Resizes with default-initialized new elements: objects of trivial types are left uninitialized, so a buffer that
+  // is about to be overwritten, for example by read(), is not written twice. Resize(new_size) does the same; this
+  // spelling states the intent at the call site.
+  void ResizeUninitialized(SizeType new_size) {
+    Resize(new_size);
+  }
+
+  // Returns room for count more elements past the end for the caller to fill, then CommitAppend(filled) with the
+  // number actually written adds them to the vector. The room grows with the growth policy, so repeated calls are
+  // amortized. Limited to trivial types, whose objects need no construction.
+  Pointer AppendUninitialized(SizeType count) {
+    static_assert(std::is_trivial_v<ValueType>, "uninitialized elements require a trivial type");
+    if (count > capacity_ - size_) {
+      Reserve(GrowCapacity(size_ + count));
+    }
+    return buffer_ + size_;
+  }
+
+  void CommitAppend(SizeType count) {
+    static_assert(std::is_trivial_v<ValueType>, "uninitialized elements require a trivial type");
+    if (count > capacity_ - size_) {
+      throw std::out_of_range("CommitAppend(SizeType)");
+    }
+    size_ += count;
   }
 
   void Reserve(SizeType new_capacity) {
     if (new_capacity <= capacity_) {
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](new_capacity * sizeof(ValueType)));
+    new_capacity = FitCapacity(new_capacity);
+    if (Remap(new_capacity)) {
+      return;
+    }
+    auto new_buffer = Allocate(new_capacity);
     if (buffer_ == nullptr) {
       buffer_ = new_buffer;
       capacity_ = new_capacity;
       return;
     }
     try {
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
+      MoveBuffer(new_buffer, new_capacity);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, new_capacity);
       throw;
     }
-    std::destroy_n(buffer_, size_);
-    operator delete[](buffer_);
-    buffer_ = new_buffer;
-    capacity_ = new_capacity;
   }
 
+  // Shrinks the capacity to the size, or to the smallest capacity the growth policy allows for it.
   void ShrinkToFit() {
     if (size_ == capacity_ || buffer_ == nullptr) {
       return;
     }
     if (size_ == 0) {
-      operator delete[](buffer_);
+      Deallocate(buffer_, capacity_);
       buffer_ = nullptr;
       capacity_ = size_;
       return;
     }
-    auto new_buffer = static_cast<Pointer>(operator new[](size_ * sizeof(ValueType)));
+    const SizeType new_capacity = FitCapacity(size_);
+    if (new_capacity >= capacity_ || Remap(new_capacity)) {
+      return;
+    }
+    auto new_buffer = Allocate(new_capacity);
     try {
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
+      MoveBuffer(new_buffer, new_capacity);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, new_capacity);
       throw;
     }
-    std::destroy_n(buffer_, size_);
-    operator delete[](buffer_);
-    buffer_ = new_buffer;
-    capacity_ = size_;
   }
 
   void Clear() {
     if (size_ > 0) {
-      std::destroy_n(buffer_, size_);
+      Destroy(buffer_, size_);
       size_ = 0;
     }
   }
 
   void PushBack(const ValueType& value) {
-    if (size_ < capacity_) {
-      new (buffer_ + size_) ValueType(value);
-      size_++;
-      return;
+    EmplaceBack(value);
+  }
+
+  void PushBack(ValueType&& value) {
+    EmplaceBack(std::move(value));
+  }
+
+  void PopBack() {
+    if (size_ == 0) {
+      throw std::out_of_range("PopBack()");
     }
-    SizeType new_capacity = (capacity_ == 0 ? 1 : capacity_ * 2);
-    auto new_buffer = static_cast<Pointer>(operator new[](new_capacity * sizeof(ValueType)));
+    size_--;
+    std::destroy_at(buffer_ + size_);
+  }
+
+  // Constructs the element in its final place. On reallocation it is constructed in the new buffer before the old
+  // elements are moved, so the arguments may refer to elements of the vector.
+  template <class... Args>
+  Reference EmplaceBack(Args&&... args) {
+    if (size_ < capacity_ || Remap(GrowCapacity(size_ + 1), args...)) {
+      new (buffer_ + size_) ValueType(std::forward<Args>(args)...);
+      return buffer_[size_++];
+    }
+    const SizeType new_capacity = GrowCapacity(size_ + 1);
+    auto new_buffer = Allocate(new_capacity);
     try {
-      new (new_buffer + size_) ValueType(value);
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
+      new (new_buffer + size_) ValueType(std::forward<Args>(args)...);
     } catch (...) {
-      operator delete[](new_buffer);
+      Deallocate(new_buffer, new_capacity);
       throw;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
+    try {
+      MoveBuffer(new_buffer, new_capacity);
+    } catch (...) {
+      std::destroy_at(new_buffer + size_);
+      Deallocate(new_buffer, new_capacity);
+      throw;
     }
-    buffer_ = new_buffer;
-    size_++;
-    capacity_ = new_capacity;
+    return buffer_[size_++];
   }
 
-  void PushBack(ValueType&& value) {
-    if (size_ < capacity_) {
-      new (buffer_ + size_) ValueType(std::move(value));
+  // Inserts an element constructed from args before position. Trivially relocatable elements are shifted with memmove
+  // and the new one is constructed in place; otherwise it is constructed aside and moved into the gap, as the slot is
+  // still occupied. Gives the strong guarantee when appending, reallocating or shifting relocatable elements.
+  template <class... Args>
+  Iterator Emplace(ConstIterator position, Args&&... args) {
+    const SizeType index = position - buffer_;
+    if (index == size_) {
+      EmplaceBack(std::forward<Args>(args)...);
+      return buffer_ + index;
+    }
+    if (size_ == capacity_ && !Remap(GrowCapacity(size_ + 1), args...)) {
+      const SizeType new_capacity = GrowCapacity(size_ + 1);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        new (new_buffer + index) ValueType(std::forward<Args>(args)...);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      try {
+        MoveBuffer(new_buffer, new_capacity, index, 1);
+      } catch (...) {
+        std::destroy_at(new_buffer + index);
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      size_++;
+      return buffer_ + index;
+    }
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      const size_t shifted = (size_ - index) * sizeof(ValueType);
+      if (!(Aliases(buffer_ + index, buffer_ + size_, args) || ...)) {
+        std::memmove(static_cast<void*>(buffer_ + index + 1), static_cast<const void*>(buffer_ + index), shifted);
+        try {
+          new (buffer_ + index) ValueType(std::forward<Args>(args)...);
+        } catch (...) {
+          std::memmove(static_cast<void*>(buffer_ + index), static_cast<const void*>(buffer_ + index + 1), shifted);
+          throw;
+        }
+      } else {
+        // The arguments would be shifted away: construct the element in the free slot at the end and rotate it into
+        // place.
+        new (buffer_ + size_) ValueType(std::forward<Args>(args)...);
+        alignas(ValueType) unsigned char element[sizeof(ValueType)];
+        std::memcpy(element, static_cast<const void*>(buffer_ + size_), sizeof(ValueType));
+        std::memmove(static_cast<void*>(buffer_ + index + 1), static_cast<const void*>(buffer_ + index), shifted);
+        std::memcpy(static_cast<void*>(buffer_ + index), element, sizeof(ValueType));
+      }
       size_++;
+    } else {
+      ValueType value(std::forward<Args>(args)...);
+      new (buffer_ + size_) ValueType(std::move(buffer_[size_ - 1]));
+      size_++;
+      std::move_backward(buffer_ + index, buffer_ + size_ - 2, buffer_ + size_ - 1);
+      buffer_[index] = std::move(value);
+    }
+    return buffer_ + index;
+  }
+
+  // Appends copies of [first, last) with at most one reallocation. first and last may point into the vector.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  void Append(InputIterator first, InputIterator last) {
+    Insert(end(), first, last);
+  }
+
+  // Inserts copies of [first, last) before position. Forward ranges are counted first and inserted with at most one
+  // reallocation: the elements after position are shifted by memmove when trivially relocatable, or into a buffer
+  // that already has room for the new ones. Input ranges are appended one by one and rotated into place.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  Iterator Insert(ConstIterator position, InputIterator first, InputIterator last) {
+    const SizeType index = position - buffer_;
+    if constexpr (kIsForwardIterator<InputIterator>) {
+      const SizeType count = std::distance(first, last);
+      if (count > 0) {
+        InsertWith(index, count, Aliases(buffer_, buffer_ + size_, *first), [&](Pointer destination) { std::uninitialized_copy(first, last, destination); });
+      }
+    } else {
+      const SizeType old_size = size_;
+      try {
+        for (; first != last; ++first) {
+          EmplaceBack(*first);
+        }
+      } catch (...) {
+        std::destroy_n(buffer_ + old_size, size_ - old_size);
+        size_ = old_size;
+        throw;
+      }
+      RotateTail(index, old_size);
+    }
+    return buffer_ + index;
+  }
+
+  Iterator Insert(ConstIterator position, SizeType count, const ValueType& value) {
+    const SizeType index = position - buffer_;
+    if (count > 0) {
+      InsertWith(index, count, Aliases(buffer_, buffer_ + size_, value), [&](Pointer destination) { std::uninitialized_fill_n(destination, count, value); });
+    }
+    return buffer_ + index;
+  }
+
+  Iterator Insert(ConstIterator position, std::initializer_list<ValueType> list) {
+    return Insert(position, list.begin(), list.end());
+  }
+
+  // Replaces the contents with copies of [first, last), reusing the buffer when it is large enough.
+  template <class InputIterator, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag, IteratorCategory<InputIterator>>>>
+  void Assign(InputIterator first, InputIterator last) {
+    if constexpr (!kIsForwardIterator<InputIterator>) {
+      Clear();
+      Append(first, last);
       return;
     }
-    SizeType new_capacity = (capacity_ == 0 ? 1 : capacity_ * 2);
-    auto new_buffer = static_cast<Pointer>(operator new[](new_capacity * sizeof(ValueType)));
-    try {
-      new (new_buffer + size_) ValueType(std::move(value));
-      std::uninitialized_move_n(buffer_, size_, new_buffer);
-    } catch (...) {
-      operator delete[](new_buffer);
-      throw;
+    const SizeType count = std::distance(first, last);
+    if (count > capacity_) {
+      const SizeType new_capacity = FitCapacity(count);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        std::uninitialized_copy(first, last, new_buffer);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      Release();
+      buffer_ = new_buffer;
+      size_ = count;
+      capacity_ = new_capacity;
+      return;
     }
-    if (buffer_ != nullptr) {
-      std::destroy_n(buffer_, size_);
-      operator delete[](buffer_);
+    if (count <= size_) {
+      // A subrange of the vector itself is never behind its destination, so the forward copy is safe.
+      std::copy(first, last, buffer_);
+      std::destroy_n(buffer_ + count, size_ - count);
+    } else {
+      auto middle = std::next(first, size_);
+      std::copy(first, middle, buffer_);
+      std::uninitialized_copy(middle, last, buffer_ + size_);
     }
-    buffer_ = new_buffer;
-    size_++;
-    capacity_ = new_capacity;
+    size_ = count;
   }
 
-  void PopBack() {
-    if (size_ == 0) {
-      throw std::out_of_range("PopBack()");
+  void Assign(SizeType count, const ValueType& value) {
+    if (count > capacity_) {
+      const SizeType new_capacity = FitCapacity(count);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        UninitializedFill(new_buffer, count, value);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      Release();
+      buffer_ = new_buffer;
+      size_ = count;
+      capacity_ = new_capacity;
+      return;
     }
-    size_--;
-    std::destroy_at(buffer_ + size_);
+    if (count <= size_) {
+      std::fill_n(buffer_, count, value);
+      std::destroy_n(buffer_ + count, size_ - count);
+    } else {
+      std::fill_n(buffer_, size_, value);
+      std::uninitialized_fill_n(buffer_ + size_, count - size_, value);
+    }
+    size_ = count;
   }
 
-  template <class... Args>
-  void EmplaceBack(Args&&... args) {
-    PushBack(ValueType(std::forward<Args>(args)...));
+  void Assign(std::initializer_list<ValueType> list) {
+    Assign(list.begin(), list.end());
   }
 
   Iterator begin() {  // NOLINT
@@ -458,55 +1229,307 @@ class Vector {
  private:
   Pointer buffer_{nullptr};
   SizeType size_{0}, capacity_{0};
+
+  // malloc only guarantees alignof(std::max_align_t), so over-aligned buffers skip the realloc tier.
+  static VectorStorage GetStorage(SizeType capacity) {
+    if constexpr (kRemappable) {
+      const VectorStorage storage = GetVectorStorage(capacity * sizeof(ValueType));
+      if (storage == VectorStorage::kRealloc && kStorageAlignment > alignof(std::max_align_t)) {
+        return VectorStorage::kAllocator;
+      }
+      return storage;
+    } else {
+      return VectorStorage::kAllocator;
+    }
+  }
+
+  Pointer Allocate(SizeType capacity) {
+    if (GetStorage(capacity) != VectorStorage::kAllocator) {
+      return static_cast<Pointer>(AllocateVectorStorage(capacity * sizeof(ValueType)));
+    }
+    return AllocatorTraits::allocate(this->GetAllocatorReference(), capacity);
+  }
+
+  void Deallocate(Pointer buffer, SizeType capacity) {
+    if (GetStorage(capacity) != VectorStorage::kAllocator) {
+      DeallocateVectorStorage(buffer, capacity * sizeof(ValueType));
+      return;
+    }
+    AllocatorTraits::deallocate(this->GetAllocatorReference(), buffer, capacity);
+  }
+
+  SizeType GrowCapacity(SizeType required) const {
+    return Growth::Grow(capacity_, required, sizeof(ValueType));
+  }
+
+  static SizeType FitCapacity(SizeType required) {
+    return Growth::Fit(required, sizeof(ValueType));
+  }
+
+  // Whether object lies in [begin, end).
+  template <class Object>
+  static bool Aliases(ConstPointer begin, ConstPointer end, const Object& object) {
+    auto address = reinterpret_cast<const char*>(std::addressof(object));
+    return std::less_equal<const char*>()(reinterpret_cast<const char*>(begin), address) && std::less<const char*>()(address, reinterpret_cast<const char*>(end));
+  }
+
+  // Resizes the buffer with realloc or mremap when both capacities fall into the same such storage. Returns false,
+  // leaving everything as it was, when this is not possible or when one of keep lies in the buffer.
+  template <class... Keep>
+  bool Remap(SizeType new_capacity, const Keep&... keep) {
+    if constexpr (kRemappable) {
+      const VectorStorage storage = GetStorage(capacity_);
+      if (buffer_ == nullptr || storage == VectorStorage::kAllocator || storage != GetStorage(new_capacity)) {
+        return false;
+      }
+      if ((Aliases(buffer_, buffer_ + capacity_, keep) || ...)) {
+        return false;
+      }
+      buffer_ = static_cast<Pointer>(ReallocateVectorStorage(buffer_, capacity_ * sizeof(ValueType), new_capacity * sizeof(ValueType)));
+      capacity_ = new_capacity;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // Inserts count elements before index, constructed in uninitialized memory by construct(destination). aliased tells
+  // that construct reads elements of the vector, which must then stay in place until it returns.
+  template <class Construct>
+  void InsertWith(SizeType index, SizeType count, bool aliased, Construct construct) {
+    const SizeType new_size = size_ + count;
+    if (new_size > capacity_ && (aliased || !Remap(GrowCapacity(new_size)))) {
+      const SizeType new_capacity = GrowCapacity(new_size);
+      auto new_buffer = Allocate(new_capacity);
+      try {
+        construct(new_buffer + index);
+      } catch (...) {
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      try {
+        MoveBuffer(new_buffer, new_capacity, index, count);
+      } catch (...) {
+        std::destroy_n(new_buffer + index, count);
+        Deallocate(new_buffer, new_capacity);
+        throw;
+      }
+      size_ = new_size;
+      return;
+    }
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      if (!aliased) {
+        const size_t shifted = (size_ - index) * sizeof(ValueType);
+        std::memmove(static_cast<void*>(buffer_ + index + count), static_cast<const void*>(buffer_ + index), shifted);
+        try {
+          construct(buffer_ + index);
+        } catch (...) {
+          std::memmove(static_cast<void*>(buffer_ + index), static_cast<const void*>(buffer_ + index + count), shifted);
+          throw;
+        }
+        size_ = new_size;
+        return;
+      }
+    }
+    construct(buffer_ + size_);
+    const SizeType old_size = size_;
+    size_ = new_size;
+    RotateTail(index, old_size);
+  }
+
+  // Moves the elements [old_size, size_) before index.
+  void RotateTail(SizeType index, SizeType old_size) {
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      auto bytes = reinterpret_cast<unsigned char*>(buffer_);
+      std::rotate(bytes + index * sizeof(ValueType), bytes + old_size * sizeof(ValueType), bytes + size_ * sizeof(ValueType));
+    } else {
+      std::rotate(buffer_ + index, buffer_ + old_size, buffer_ + size_);
+    }
+  }
+
+  // Relocates the elements into new_buffer and frees the old buffer. If a move constructor throws, nothing changes
+  // except that some elements may have been moved from.
+  void MoveBuffer(Pointer new_buffer, SizeType new_capacity) {
+    MoveBuffer(new_buffer, new_capacity, size_, 0);
+  }
+
+  // The same, leaving a gap of gap_size elements before the element at index gap.
+  void MoveBuffer(Pointer new_buffer, SizeType new_capacity, SizeType gap, SizeType gap_size) {
+    if constexpr (IsTriviallyRelocatable<ValueType>::value) {
+      if (gap > 0) {
+        std::memcpy(static_cast<void*>(new_buffer), static_cast<const void*>(buffer_), gap * sizeof(ValueType));
+      }
+      if (gap < size_) {
+        std::memcpy(static_cast<void*>(new_buffer + gap + gap_size), static_cast<const void*>(buffer_ + gap), (size_ - gap) * sizeof(ValueType));
+      }
+    } else {
+      std::uninitialized_move_n(buffer_, gap, new_buffer);
+      try {
+        std::uninitialized_move_n(buffer_ + gap, size_ - gap, new_buffer + gap + gap_size);
+      } catch (...) {
+        std::destroy_n(new_buffer, gap);
+        throw;
+      }
+      std::destroy_n(buffer_, size_);
+    }
+    if (buffer_ != nullptr) {
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+  }
+
+  // Bulk operations, split by ForEachVectorChunk for types that are IsParallelConstructible. Types with trivial
+  // construction or destruction skip the work entirely.
+  template <class Process, class Rollback>
+  static void ForEachChunk(SizeType size, Process process, Rollback rollback) {
+    if constexpr (IsParallelConstructible<ValueType>::value) {
+      ForEachVectorChunk(size, sizeof(ValueType), process, rollback);
+    } else if (size > 0) {
+      process(SizeType{0}, size);
+    }
+  }
+
+  static void UninitializedDefaultConstruct(Pointer buffer, SizeType size) {
+    if constexpr (!std::is_trivially_default_constructible_v<ValueType>) {
+      auto construct = [buffer](SizeType begin, SizeType end) { std::uninitialized_default_construct_n(buffer + begin, end - begin); };
+      auto destroy = [buffer](SizeType begin, SizeType end) { std::destroy_n(buffer + begin, end - begin); };
+      ForEachChunk(size, construct, destroy);
+    }
+  }
+
+  static void UninitializedFill(Pointer buffer, SizeType size, const ValueType& value) {
+    auto fill = [buffer, &value](SizeType begin, SizeType end) { std::uninitialized_fill_n(buffer + begin, end - begin, value); };
+    auto destroy = [buffer](SizeType begin, SizeType end) { std::destroy_n(buffer + begin, end - begin); };
+    ForEachChunk(size, fill, destroy);
+  }
+
+  static void UninitializedCopy(ConstPointer source, SizeType size, Pointer buffer) {
+    auto copy = [source, buffer](SizeType begin, SizeType end) { std::uninitialized_copy_n(source + begin, end - begin, buffer + begin); };
+    auto destroy = [buffer](SizeType begin, SizeType end) { std::destroy_n(buffer + begin, end - begin); };
+    ForEachChunk(size, copy, destroy);
+  }
+
+  static void Destroy(Pointer buffer, SizeType size) {
+    if constexpr (!std::is_trivially_destructible_v<ValueType>) {
+      auto destroy = [buffer](SizeType begin, SizeType end) { std::destroy_n(buffer + begin, end - begin); };
+      ForEachChunk(size, destroy, [](SizeType, SizeType) {});
+    }
+  }
+
+  void Release() {
+    if (buffer_ != nullptr) {
+      Destroy(buffer_, size_);
+      Deallocate(buffer_, capacity_);
+    }
+    buffer_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+  }
 };
 
-template <class ValueType>
-int8_t Compare(const Vector<ValueType>& left, const Vector<ValueType>& right) {
-  for (size_t i = 0, size = std::min(left.Size(), right.Size()); i < size; i++) {
-    if (left[i] < right[i]) {
-      return -1;
+// Index of the first position where left and right differ, or size. Equal prefixes are skipped in blocks with memcmp,
+// which the C library vectorizes; only the block with the mismatch is searched element by element.
+template <class T>
+size_t FindVectorMismatch(const T* left, const T* right, size_t size) {
+  constexpr size_t kBlock = 256 / sizeof(T) > 0 ? 256 / sizeof(T) : 1;
+  size_t i = 0;
+  while (i + kBlock <= size && std::memcmp(left + i, right + i, kBlock * sizeof(T)) == 0) {
+    i += kBlock;
+  }
+  while (i < size && left[i] == right[i]) {
+    i++;
+  }
+  return i;
+}
+
+// Lexicographic comparison of two arrays, shared by the vector types. Bytes are compared with a single memcmp, which
+// orders unsigned bytes correctly; other integral types search the first mismatch with FindVectorMismatch and compare
+// only there.
+template <class T>
+int8_t CompareVectorElements(const T* left, size_t left_size, const T* right, size_t right_size) {
+  const size_t size = std::min(left_size, right_size);
+  if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 1) {
+    const int result = size > 0 ? std::memcmp(left, right, size) : 0;
+    if (result != 0) {
+      return result < 0 ? -1 : 1;
+    }
+  } else if constexpr (std::is_integral_v<T>) {
+    const size_t i = size > 0 ? FindVectorMismatch(left, right, size) : 0;
+    if (i < size) {
+      return left[i] < right[i] ? -1 : 1;
     }
-    if (left[i] > right[i]) {
-      return 1;
+  } else {
+    for (size_t i = 0; i < size; i++) {
+      if (left[i] < right[i]) {
+        return -1;
+      }
+      if (left[i] > right[i]) {
+        return 1;
+      }
     }
   }
-  if (left.Size() < right.Size()) {
+  if (left_size < right_size) {
     return -1;
   }
-  if (left.Size() > right.Size()) {
+  if (left_size > right_size) {
     return 1;
   }
   return 0;
 }
 
-template <class ValueType>
-bool operator<(const Vector<ValueType>& left, const Vector<ValueType>& right) {
+// Arrays of different sizes are never equal. Integers, enums and pointers are equal exactly when their bytes are, so
+// they are compared with memcmp.
+template <class T>
+bool EqualVectorElements(const T* left, size_t left_size, const T* right, size_t right_size) {
+  if (left_size != right_size) {
+    return false;
+  }
+  if constexpr (std::is_scalar_v<T> && std::has_unique_object_representations_v<T>) {
+    return left_size == 0 || std::memcmp(left, right, left_size * sizeof(T)) == 0;
+  } else {
+    return CompareVectorElements(left, left_size, right, right_size) == 0;
+  }
+}
+
+template <class ValueType, class Allocator, class Growth>
+int8_t Compare(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
+  return CompareVectorElements(left.Data(), left.Size(), right.Data(), right.Size());
+}
+
+template <class ValueType, class Allocator, class Growth>
+bool Equal(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
+  return EqualVectorElements(left.Data(), left.Size(), right.Data(), right.Size());
+}
+
+template <class ValueType, class Allocator, class Growth>
+bool operator<(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
   return Compare(left, right) < 0;
 }
 
-template <class ValueType>
-bool operator>(const Vector<ValueType>& left, const Vector<ValueType>& right) {
+template <class ValueType, class Allocator, class Growth>
+bool operator>(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
   return Compare(left, right) > 0;
 }
 
-template <class ValueType>
-bool operator<=(const Vector<ValueType>& left, const Vector<ValueType>& right) {
+template <class ValueType, class Allocator, class Growth>
+bool operator<=(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
   return Compare(left, right) <= 0;
 }
 
-template <class ValueType>
-bool operator>=(const Vector<ValueType>& left, const Vector<ValueType>& right) {
+template <class ValueType, class Allocator, class Growth>
+bool operator>=(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
   return Compare(left, right) >= 0;
 }
 
-template <class ValueType>
-bool operator==(const Vector<ValueType>& left, const Vector<ValueType>& right) {
-  return Compare(left, right) == 0;
+template <class ValueType, class Allocator, class Growth>
+bool operator==(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
+  return Equal(left, right);
 }
 
-template <class ValueType>
-bool operator!=(const Vector<ValueType>& left, const Vector<ValueType>& right) {
-  return Compare(left, right) != 0;
+template <class ValueType, class Allocator, class Growth>
+bool operator!=(const Vector<ValueType, Allocator, Growth>& left, const Vector<ValueType, Allocator, Growth>& right) {
+  return !Equal(left, right);
 }
 
 #endif
@@ -0,0 +1,194 @@
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "soa_vector.h"
+#include "vector.h"
+
+// The same payload as Vector<int>, but without the IsTriviallyRelocatable specialization, so Vector relocates it by
+// move construction and destruction.
+struct MovedVector {
+  Vector<int> value;
+
+  MovedVector() = default;
+
+  explicit MovedVector(size_t size) : value(size, 1) {
+  }
+};
+
+template <class T>
+using Maker = T (*)(size_t);
+
+// Time of three doubling Reserve calls on a vector of count elements: pure relocation cost, no new elements are
+// constructed.
+template <class T>
+double MeasureReallocation(size_t count, Maker<T> make, size_t repeats) {
+  double best = 0;
+  for (size_t repeat = 0; repeat < repeats; repeat++) {
+    Vector<T> v;
+    v.Reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      v.PushBack(make(i));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t capacity = count * 2; capacity <= count * 8; capacity *= 2) {
+      v.Reserve(capacity);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (repeat == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+// Time of PushBack into an empty vector, which includes the log2(count) reallocations.
+template <class T>
+double MeasurePushBack(size_t count, Maker<T> make, size_t repeats) {
+  double best = 0;
+  for (size_t repeat = 0; repeat < repeats; repeat++) {
+    auto start = std::chrono::steady_clock::now();
+    Vector<T> v;
+    for (size_t i = 0; i < count; i++) {
+      v.PushBack(make(i));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (repeat == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+template <class T>
+void Report(const char* name, size_t count, Maker<T> make) {
+  std::printf("%-22s relocatable=%d  reallocate x3: %8.3f ms  push_back: %8.3f ms\n", name, IsTriviallyRelocatable<T>::value, MeasureReallocation<T>(count, make, 5) * 1e3, MeasurePushBack<T>(count, make, 5) * 1e3);
+}
+
+// Big enough that its move construction is not free.
+struct Heavy {
+  std::array<double, 32> payload;
+  std::string name;
+
+  Heavy(size_t seed, const char* name_param) : name{name_param} {
+    payload.fill(static_cast<double>(seed));
+  }
+};
+
+// Time of EmplaceBack into a reserved vector, constructing either in place or from a temporary as PushBack does.
+double MeasureEmplaceBack(size_t count, bool temporary, size_t repeats) {
+  double best = 0;
+  for (size_t repeat = 0; repeat < repeats; repeat++) {
+    Vector<Heavy> v;
+    v.Reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+      if (temporary) {
+        v.PushBack(Heavy(i, "heavy"));
+      } else {
+        v.EmplaceBack(i, "heavy");
+      }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (repeat == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+// The element-wise comparison Compare used before memcmp.
+bool ScalarLess(const Vector<uint8_t>& left, const Vector<uint8_t>& right) {
+  for (size_t i = 0, size = std::min(left.Size(), right.Size()); i < size; i++) {
+    if (left[i] < right[i]) {
+      return true;
+    }
+    if (left[i] > right[i]) {
+      return false;
+    }
+  }
+  return left.Size() < right.Size();
+}
+
+// Time of sorting and deduplicating count keys of 64 bytes that share a 48-byte prefix.
+template <class Less>
+double MeasureSortKeys(size_t count, Less less) {
+  Vector<Vector<uint8_t>> keys;
+  uint64_t state = 1;
+  for (size_t i = 0; i < count; i++) {
+    Vector<uint8_t> key(64u, 7);
+    for (size_t j = 48; j < 64; j++) {
+      state = state * 6364136223846793005u + 1442695040888963407u;
+      key[j] = static_cast<uint8_t>(state >> 62);
+    }
+    keys.PushBack(std::move(key));
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::sort(keys.begin(), keys.end(), less);
+  keys.Resize(std::unique(keys.begin(), keys.end()) - keys.begin());
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nine fields, of which the integration step reads two and writes one.
+struct Particle {
+  double x, y, z;
+  double vx, vy, vz;
+  double mass, charge, age;
+};
+
+// Time of advancing count particles by repeated x += vx * dt, stored as an array of structures or in columns.
+double MeasureParticles(size_t count, bool columns, size_t steps) {
+  Vector<Particle> rows(count, Particle{0, 0, 0, 1, 1, 1, 1, 0, 0});
+  SoaVector<double, double, double, double, double, double, double, double, double> table;
+  for (size_t i = 0; i < count; i++) {
+    table.PushBack(0, 0, 0, 1, 1, 1, 1, 0, 0);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < steps; step++) {
+    if (columns) {
+      double* x = table.Data<0>();
+      const double* vx = table.Data<3>();
+      for (size_t i = 0; i < count; i++) {
+        x[i] += vx[i] * 0.01;
+      }
+    } else {
+      for (auto& particle : rows) {
+        particle.x += particle.vx * 0.01;
+      }
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return seconds;
+}
+
+// Peak resident memory of growing a Vector<uint64_t> to the given size by PushBack, relative to its final buffer. Must
+// run first, as the peak only grows during the process lifetime.
+void ReportPeakMemory(size_t count) {
+  Vector<uint64_t> v;
+  for (size_t i = 0; i < count; i++) {
+    v.PushBack(i);
+  }
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  double peak = static_cast<double>(usage.ru_maxrss) * 1024;
+  std::printf("Vector<uint64_t> of %zu MiB: peak RSS %.2fx the buffer\n", count * sizeof(uint64_t) >> 20, peak / static_cast<double>(v.Capacity() * sizeof(uint64_t)));
+}
+
+int main() {
+  ReportPeakMemory(size_t{1} << 25);
+  constexpr size_t kCount = 1 << 18;
+  std::printf("%zu elements\n", kCount);
+  Report<Vector<int>>("Vector<Vector<int>>", kCount, [](size_t i) { return Vector<int>(i % 8, 1); });
+  Report<MovedVector>("Vector<MovedVector>", kCount, [](size_t i) { return MovedVector(i % 8); });
+  Report<std::string>("Vector<std::string>", kCount, [](size_t i) { return std::string(i % 32, 'x'); });
+  std::printf("Vector<Heavy>          emplace in place: %8.3f ms  from a temporary: %8.3f ms\n", MeasureEmplaceBack(kCount, false, 5) * 1e3, MeasureEmplaceBack(kCount, true, 5) * 1e3);
+  std::printf("sort and unique Vector<uint8_t> keys  memcmp: %8.3f ms  scalar loop: %8.3f ms\n", MeasureSortKeys(1 << 20, [](const auto& left, const auto& right) { return left < right; }) * 1e3, MeasureSortKeys(1 << 20, ScalarLess) * 1e3);
+  std::printf("x += vx * dt over particles  SoaVector columns: %8.3f ms  Vector<Particle>: %8.3f ms\n", MeasureParticles(1 << 20, true, 50) * 1e3, MeasureParticles(1 << 20, false, 50) * 1e3);
+  return 0;
+}
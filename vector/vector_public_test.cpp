@@ -1,13 +1,28 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 #include <type_traits>
 
 #include "vector.h"
 #include "vector.h"  // check include guards
+#include "memory_resource.h"
+#include "small_vector.h"
+#include "mapped_vector.h"
+#include "concurrent_vector.h"
+#include "soa_vector.h"
+#include "shared_vector.h"
 
 template <class T>
 void Equal(const Vector<T>& real, const std::vector<T>& required) {
@@ -1426,3 +1441,1236 @@ TEST_CASE("PopBack Memory", "[Memory]") {
 }
 
 #endif
+
+template <class T>
+struct PropagatingAllocator {
+  using value_type = T;                                           // NOLINT
+  using propagate_on_container_copy_assignment = std::true_type;  // NOLINT
+  using propagate_on_container_move_assignment = std::true_type;  // NOLINT
+  using propagate_on_container_swap = std::true_type;             // NOLINT
+
+  int id = 0;
+
+  PropagatingAllocator() = default;
+
+  explicit PropagatingAllocator(int id_param) : id(id_param) {
+  }
+
+  template <class U>
+  PropagatingAllocator(const PropagatingAllocator<U>& other) : id(other.id) {  // NOLINT
+  }
+
+  T* allocate(size_t count) {  // NOLINT
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* pointer, size_t count) {  // NOLINT
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  friend bool operator==(const PropagatingAllocator& left, const PropagatingAllocator& right) {
+    return left.id == right.id;
+  }
+
+  friend bool operator!=(const PropagatingAllocator& left, const PropagatingAllocator& right) {
+    return left.id != right.id;
+  }
+};
+
+TEST_CASE("Allocators", "[Allocator]") {
+  using ResourceVector = Vector<std::string, ResourceAllocator<std::string>>;
+
+  REQUIRE(sizeof(Vector<int>) == 3 * sizeof(void*));
+
+  {
+    MonotonicArena arena(256);
+    ResourceVector v(&arena);
+    for (int i = 0; i < 100; ++i) {
+      v.PushBack(std::to_string(i));
+    }
+    REQUIRE(v.GetAllocator().GetResource() == &arena);
+    REQUIRE(arena.Reserved() >= 100 * sizeof(std::string));
+    const auto copy = v;
+    REQUIRE(copy.GetAllocator().GetResource() == &arena);
+    REQUIRE(copy == v);
+    REQUIRE(copy[42] == "42");
+  }
+
+  {
+    MonotonicArena first;
+    MonotonicArena second;
+    ResourceVector a({"a", "b", "c"}, &first);
+    ResourceVector b(5u, std::string("x"), &second);
+    const auto data = a.Data();
+    b = std::move(a);
+    REQUIRE(b.GetAllocator().GetResource() == &second);
+    REQUIRE(b.Data() != data);
+    REQUIRE(b.Size() == 3u);
+    REQUIRE(b[2] == "c");
+
+    ResourceVector c({"d"}, &first);
+    c.Swap(b);
+    REQUIRE(c.GetAllocator().GetResource() == &first);
+    REQUIRE(b.GetAllocator().GetResource() == &second);
+    REQUIRE(c.Size() == 3u);
+    REQUIRE(b.Size() == 1u);
+    REQUIRE(c[0] == "a");
+    REQUIRE(b[0] == "d");
+
+    ResourceVector d({"e", "f"}, &first);
+    const auto d_data = d.Data();
+    c = std::move(d);
+    REQUIRE(c.Data() == d_data);
+    REQUIRE(d.Data() == nullptr);
+  }
+
+  {
+    SizeClassPool pool;
+    Vector<int, ResourceAllocator<int>> v(&pool);
+    v.Reserve(20u);
+    const auto data = v.Data();
+    v.ShrinkToFit();
+    Vector<int, ResourceAllocator<int>> w(20u, 7, &pool);
+    REQUIRE(w.Data() == data);
+    Vector<int, ResourceAllocator<int>> large(10'000u, 1, &pool);
+    REQUIRE(large[9'999] == 1);
+  }
+
+  {
+    using PropagatingVector = Vector<int, PropagatingAllocator<int>>;
+    PropagatingVector a({1, 2, 3}, PropagatingAllocator<int>(1));
+    PropagatingVector b(PropagatingAllocator<int>(2));
+    b = a;
+    REQUIRE(b.GetAllocator().id == 1);
+    PropagatingVector c(PropagatingAllocator<int>(3));
+    c.Swap(b);
+    REQUIRE(c.GetAllocator().id == 1);
+    REQUIRE(b.GetAllocator().id == 3);
+    PropagatingVector d(PropagatingAllocator<int>(4));
+    d = std::move(c);
+    REQUIRE(d.GetAllocator().id == 1);
+    REQUIRE(d == a);
+  }
+}
+
+struct RelocationCounter {
+  static size_t moves;
+
+  int value = 0;
+
+  RelocationCounter() = default;
+
+  explicit RelocationCounter(int value_param) : value(value_param) {
+  }
+
+  RelocationCounter(const RelocationCounter& other) : value(other.value) {
+  }
+
+  RelocationCounter(RelocationCounter&& other) noexcept : value(other.value) {
+    ++moves;
+  }
+
+  ~RelocationCounter() {
+  }
+};
+
+size_t RelocationCounter::moves = 0u;
+
+template <>
+struct IsTriviallyRelocatable<RelocationCounter> : std::true_type {};
+
+struct SelfPointer {
+  SelfPointer* self = this;
+  int value = 0;
+
+  SelfPointer() = default;
+
+  explicit SelfPointer(int value_param) : value(value_param) {
+  }
+
+  SelfPointer(const SelfPointer& other) : value(other.value) {
+  }
+
+  SelfPointer& operator=(const SelfPointer& other) {
+    value = other.value;
+    return *this;
+  }
+};
+
+TEST_CASE("Relocation", "[Relocation]") {
+  static_assert(IsTriviallyRelocatable<int>::value);
+  static_assert(IsTriviallyRelocatable<std::unique_ptr<int>>::value);
+  static_assert(IsTriviallyRelocatable<Vector<int>>::value);
+  static_assert(IsTriviallyRelocatable<Vector<std::string>>::value);
+  static_assert(!IsTriviallyRelocatable<SelfPointer>::value);
+
+  {
+    RelocationCounter::moves = 0u;
+    Vector<RelocationCounter> v;
+    for (int i = 0; i < 1000; ++i) {
+      v.PushBack(RelocationCounter(i));
+    }
+    v.Reserve(5000u);
+    v.Resize(6000u);
+    v.ShrinkToFit();
+    REQUIRE(RelocationCounter::moves == 1000u);
+    for (int i = 0; i < 1000; ++i) {
+      REQUIRE(v[i].value == i);
+    }
+  }
+
+  {
+    Vector<SelfPointer> v;
+    for (int i = 0; i < 100; ++i) {
+      v.EmplaceBack(i);
+    }
+    v.Resize(300u);
+    for (int i = 0; i < 300; ++i) {
+      REQUIRE(v[i].self == &v[i]);
+      REQUIRE(v[i].value == (i < 100 ? i : 0));
+    }
+  }
+
+  {
+    Vector<Vector<int>> v;
+    for (int i = 0; i < 100; ++i) {
+      v.PushBack(Vector<int>(static_cast<size_t>(i), i));
+    }
+    v.ShrinkToFit();
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(v[i] == Vector<int>(static_cast<size_t>(i), i));
+    }
+  }
+}
+
+TEST_CASE("Remap", "[Relocation]") {
+  {
+    Vector<uint64_t> v;
+    for (uint64_t i = 0; i < (1u << 21); ++i) {
+      v.PushBack(i);
+    }
+    REQUIRE(v.Capacity() == (1u << 21));
+    v.PushBack(v[12345]);
+    REQUIRE(v.Back() == 12345u);
+    v.Resize(v.Capacity() + 1, v[777]);
+    REQUIRE(v.Back() == 777u);
+    for (uint64_t i = 0; i < (1u << 21); ++i) {
+      REQUIRE(v[i] == i);
+    }
+    v.Reserve(1u << 23);
+    REQUIRE(v.Capacity() == (1u << 23));
+    REQUIRE(v[(1u << 21) - 1] == (1u << 21) - 1);
+    v.Resize(100'000u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 100'000u);
+    v.Resize(1'000u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 1'000u);
+    for (uint64_t i = 0; i < 1'000u; ++i) {
+      REQUIRE(v[i] == i);
+    }
+    const auto copy = v;
+    REQUIRE(copy == v);
+  }
+
+  {
+    Vector<int> v(20'000u, 3);
+    v.Resize(200'000u);
+    v.Reserve(500'000u);
+    auto moved = std::move(v);
+    REQUIRE(moved.Capacity() == 500'000u);
+    REQUIRE(moved[19'999] == 3);
+  }
+}
+
+TEST_CASE("SmallVector", "[SmallVector]") {
+  {
+    SmallVector<int, 4> v;
+    const auto inline_data = v.Data();
+    REQUIRE(v.Capacity() == 4u);
+    REQUIRE(reinterpret_cast<const char*>(inline_data) >= reinterpret_cast<const char*>(&v));
+    REQUIRE(reinterpret_cast<const char*>(inline_data) < reinterpret_cast<const char*>(&v + 1));
+    for (int i = 0; i < 4; ++i) {
+      v.PushBack(i);
+    }
+    REQUIRE(v.IsInline());
+    REQUIRE(v.Data() == inline_data);
+    v.PushBack(v[0]);
+    REQUIRE_FALSE(v.IsInline());
+    REQUIRE(v.Capacity() == 8u);
+    REQUIRE(v.Back() == 0);
+    v.PopBack();
+    v.ShrinkToFit();
+    REQUIRE(v.IsInline());
+    REQUIRE(v == SmallVector<int, 4>{0, 1, 2, 3});
+  }
+
+  {
+    SmallVector<std::string, 2> inline_vector{"a", "b"};
+    SmallVector<std::string, 2> heap_vector{"c", "d", "e"};
+    const auto heap_data = heap_vector.Data();
+    auto moved = std::move(heap_vector);
+    REQUIRE(moved.Data() == heap_data);
+    REQUIRE(heap_vector.Empty());
+    REQUIRE(heap_vector.IsInline());
+    moved.Swap(inline_vector);
+    REQUIRE(inline_vector.Data() == heap_data);
+    REQUIRE(moved.IsInline());
+    REQUIRE(moved == SmallVector<std::string, 2>{"a", "b"});
+    moved = inline_vector;
+    REQUIRE(moved == inline_vector);
+    REQUIRE(moved.Data() != heap_data);
+    inline_vector = std::move(moved);
+    REQUIRE(inline_vector.Size() == 3u);
+    REQUIRE(inline_vector > SmallVector<std::string, 2>{"a", "b"});
+  }
+
+  {
+    SmallVector<SelfPointer, 3> v;
+    for (int i = 0; i < 10; ++i) {
+      v.EmplaceBack(i);
+    }
+    v.Resize(2u);
+    v.ShrinkToFit();
+    auto moved = std::move(v);
+    for (int i = 0; i < 2; ++i) {
+      REQUIRE(moved[i].self == &moved[i]);
+      REQUIRE(moved[i].value == i);
+    }
+  }
+
+  {
+    Vector<std::string> vector{"x", "y", "z"};
+    SmallVector<std::string, 4> small(vector);
+    REQUIRE(small.IsInline());
+    REQUIRE(small.ToVector() == vector);
+    SmallVector<std::string, 2> spilled(std::move(vector));
+    REQUIRE_FALSE(spilled.IsInline());
+    REQUIRE(vector.Empty());
+    vector = std::move(spilled).ToVector();
+    REQUIRE(spilled.Empty());
+    REQUIRE(vector == Vector<std::string>{"x", "y", "z"});
+  }
+
+  {
+    Throwable::until_throw = 3;
+    REQUIRE_THROWS_AS((SmallVector<Throwable, 2>(5u)), Exception);  // NOLINT
+    Throwable::until_throw = 100;
+    SmallVector<Throwable, 2> v(2u);
+    const auto data = v.Data();
+    const Throwable object;
+    Throwable::until_throw = 1;
+    REQUIRE_THROWS_AS(v.PushBack(object), Exception);  // NOLINT
+    REQUIRE(v.Size() == 2u);
+    REQUIRE(v.Data() == data);
+    REQUIRE(v.IsInline());
+  }
+
+  {
+    SmallVector<int, 2, std::allocator<int>, OneAndHalfGrowth> v{1, 2};
+    v.PushBack(3);
+    REQUIRE(v.Capacity() == 3u);
+    v.PushBack(4);
+    REQUIRE(v.Capacity() == 4u);
+    v.Resize(7u);
+    REQUIRE(v.Capacity() == 7u);
+    SmallVector<char, 4, std::allocator<char>, SizeClassGrowth<>> padded;
+    padded.Reserve(5u);
+    REQUIRE(padded.Capacity() == 16u);
+  }
+
+  {
+    MonotonicArena first;
+    MonotonicArena second;
+    using ResourceSmallVector = SmallVector<std::string, 2, ResourceAllocator<std::string>>;
+    ResourceSmallVector a({"a", "b", "c"}, &first);
+    ResourceSmallVector b(&second);
+    REQUIRE(a.GetAllocator().GetResource() == &first);
+    b = std::move(a);
+    REQUIRE(b.GetAllocator().GetResource() == &second);
+    REQUIRE(b == ResourceSmallVector{"a", "b", "c"});
+    const auto copy = b;
+    REQUIRE(copy.GetAllocator().GetResource() == &second);
+    REQUIRE(copy.ToVector().GetAllocator().GetResource() == &second);
+    ResourceSmallVector c({"d", "e", "f"}, &first);
+    c.Swap(b);
+    REQUIRE(c.GetAllocator().GetResource() == &first);
+    REQUIRE(c == copy);
+    REQUIRE(b[2] == "f");
+  }
+
+  {
+    SmallVector<std::string, 4> v{"a", "c"};
+    REQUIRE(*v.Emplace(v.begin() + 1, "b") == "b");
+    v.Append(v.begin(), v.end());
+    REQUIRE(v == SmallVector<std::string, 4>{"a", "b", "c", "a", "b", "c"});
+    v.Insert(v.begin() + 1, 2u, v[0]);
+    REQUIRE(v == SmallVector<std::string, 4>{"a", "a", "a", "b", "c", "a", "b", "c"});
+    v.Emplace(v.begin(), v.Back());
+    REQUIRE(v.Front() == "c");
+    v.Assign({"x", "y"});
+    REQUIRE(v == SmallVector<std::string, 4>{"x", "y"});
+    v.ShrinkToFit();
+    REQUIRE(v.IsInline());
+    std::istringstream input("p q r");
+    v.Insert(v.begin() + 1, std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+    REQUIRE(v == SmallVector<std::string, 4>{"x", "p", "q", "r", "y"});
+    v.Assign(3u, v[4]);
+    REQUIRE(v == SmallVector<std::string, 4>{"y", "y", "y"});
+  }
+
+  {
+    SmallVector<SelfPointer, 2> v(3u);
+    v.Emplace(v.begin() + 1, 5);
+    v.Insert(v.begin(), 2u, SelfPointer(7));
+    REQUIRE(v.Size() == 6u);
+    REQUIRE(v[3].value == 5);
+    for (size_t i = 0; i < v.Size(); ++i) {
+      REQUIRE(v[i].self == &v[i]);
+    }
+  }
+}
+
+struct Pinned {
+  std::atomic<int> value;
+  int id;
+
+  Pinned(int value_param, int id_param) : value{value_param}, id{id_param} {
+  }
+};
+
+template <>
+struct IsTriviallyRelocatable<Pinned> : std::true_type {};
+
+TEST_CASE("Emplace", "[Emplace]") {
+  {
+    RelocationCounter::moves = 0u;
+    Vector<RelocationCounter> v;
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(v.EmplaceBack(i).value == i);
+    }
+    v.Emplace(v.begin() + 50, -1);
+    v.Emplace(v.begin(), -2);
+    REQUIRE(RelocationCounter::moves == 0u);
+    REQUIRE(v.Size() == 102u);
+    REQUIRE(v[0].value == -2);
+    REQUIRE(v[51].value == -1);
+    REQUIRE(v[101].value == 99);
+  }
+
+  {
+    Vector<Pinned> v;
+    for (int i = 0; i < 10; ++i) {
+      v.EmplaceBack(i, i);
+    }
+    v.Emplace(v.begin() + 3, 42, -1);
+    REQUIRE(v[3].value == 42);
+    REQUIRE(v[4].id == 3);
+    REQUIRE(v[10].value == 9);
+  }
+
+  {
+    Vector<int> v{1, 2, 3, 4};
+    v.Reserve(8u);
+    v.Emplace(v.begin(), v[2]);
+    v.Emplace(v.begin() + 2, v.Back());
+    v.Emplace(v.begin() + 1, 0);
+    REQUIRE(v == Vector<int>{3, 0, 1, 4, 2, 3, 4});
+  }
+
+  {
+    Vector<std::string> v{"a", "b", "c"};
+    v.Reserve(3u);
+    v.EmplaceBack(v[0]);
+    v.Emplace(v.begin(), v[3]);
+    v.Emplace(v.begin() + 2, v.Back());
+    v.Emplace(v.begin() + 1, 3u, 'x');
+    REQUIRE(v == Vector<std::string>{"a", "xxx", "a", "a", "b", "c", "a"});
+    v.Reserve(100u);
+    v.Emplace(v.begin() + 1, v[5]);
+    v.Emplace(v.end() - 1, v[2]);
+    REQUIRE(v == Vector<std::string>{"a", "c", "xxx", "a", "a", "b", "c", "xxx", "a"});
+  }
+
+  {
+    Vector<SelfPointer> v;
+    for (int i = 0; i < 20; ++i) {
+      v.Emplace(v.begin() + i / 2, i);
+    }
+    for (size_t i = 0; i < v.Size(); ++i) {
+      REQUIRE(v[i].self == &v[i]);
+    }
+  }
+
+  {
+    Throwable::until_throw = 100;
+    Vector<Throwable> v(4u);
+    const auto data = v.Data();
+    const Throwable object;
+    Throwable::until_throw = 1;
+    REQUIRE_THROWS_AS(v.Emplace(v.begin() + 1, object), Exception);  // NOLINT
+    REQUIRE(v.Size() == 4u);
+    REQUIRE(v.Capacity() == 4u);
+    REQUIRE(v.Data() == data);
+  }
+}
+
+struct Tagged {
+  int value = 0;
+};
+
+template <>
+struct DefaultVectorGrowth<Tagged> : SizeClassGrowth<DoublingGrowth> {};
+
+TEST_CASE("Growth", "[ReallocationStrategy]") {
+  REQUIRE(GetAllocationSizeClass(0u) == 0u);
+  REQUIRE(GetAllocationSizeClass(1u) == 16u);
+  REQUIRE(GetAllocationSizeClass(128u) == 128u);
+  REQUIRE(GetAllocationSizeClass(129u) == 160u);
+  REQUIRE(GetAllocationSizeClass(257u) == 320u);
+  REQUIRE(GetAllocationSizeClass(1000u) == 1024u);
+  REQUIRE(GetAllocationSizeClass(1025u) == 1280u);
+
+  {
+    Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+    std::vector<size_t> capacities;
+    for (int i = 0; i < 20; ++i) {
+      v.PushBack(i);
+      if (capacities.empty() || capacities.back() != v.Capacity()) {
+        capacities.push_back(v.Capacity());
+      }
+    }
+    REQUIRE(capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28});
+    v.Resize(100u);
+    REQUIRE(v.Capacity() == 100u);
+    v.Resize(101u);
+    REQUIRE(v.Capacity() == 150u);
+  }
+
+  {
+    Vector<char, std::allocator<char>, SizeClassGrowth<>> v;
+    v.PushBack('a');
+    REQUIRE(v.Capacity() == 16u);
+    v.Reserve(130u);
+    REQUIRE(v.Capacity() == 160u);
+    v.Resize(161u, 'b');
+    REQUIRE(v.Capacity() == 256u);
+    v.Resize(20u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 32u);
+    REQUIRE(v[0] == 'a');
+    REQUIRE(v[19] == 'b');
+  }
+
+  {
+    Vector<Tagged> v(5u);
+    REQUIRE(v.Capacity() == 8u);
+    for (int i = 0; i < 9; ++i) {
+      v.PushBack({i});
+    }
+    REQUIRE(v.Capacity() == 16u);
+    REQUIRE(v.Back().value == 8);
+  }
+
+  {
+    Vector<uint64_t, std::allocator<uint64_t>, SizeClassGrowth<>> v((1u << 17) + 1);
+    REQUIRE(v.Capacity() * sizeof(uint64_t) % 4096u == 0u);
+    v.Resize(v.Capacity() + 1);
+    REQUIRE(v.Capacity() * sizeof(uint64_t) % 4096u == 0u);
+  }
+}
+
+TEST_CASE("Append", "[Bulk]") {
+  {
+    Vector<int> v{1, 2, 3};
+    const std::vector<int> other{4, 5, 6, 7};
+    v.Append(other.begin(), other.end());
+    REQUIRE(v.Capacity() == 7u);
+    v.Append(v.begin(), v.end());
+    REQUIRE(v == Vector<int>{1, 2, 3, 4, 5, 6, 7, 1, 2, 3, 4, 5, 6, 7});
+    REQUIRE(v.Capacity() == 14u);
+    v.Append(v.begin() + 12, v.end());
+    REQUIRE(v.Size() == 16u);
+    REQUIRE(v.Back() == 7);
+  }
+
+  {
+    std::istringstream input("10 20 30");
+    Vector<int> v{1};
+    v.Append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+    REQUIRE(v == Vector<int>{1, 10, 20, 30});
+    std::istringstream more("5 6");
+    const Vector<int> from_input(std::istream_iterator<int>(more), (std::istream_iterator<int>()));
+    REQUIRE(from_input == Vector<int>{5, 6});
+  }
+
+  {
+    Vector<std::string> v{"a", "b"};
+    v.Reserve(10u);
+    const auto data = v.Data();
+    v.Append(v.begin(), v.end());
+    REQUIRE(v.Data() == data);
+    REQUIRE(v == Vector<std::string>{"a", "b", "a", "b"});
+  }
+}
+
+TEST_CASE("Insert", "[Bulk]") {
+  {
+    Vector<int> v{1, 2, 3};
+    const std::vector<int> other{7, 8};
+    REQUIRE(*v.Insert(v.begin() + 1, other.begin(), other.end()) == 7);
+    REQUIRE(v == Vector<int>{1, 7, 8, 2, 3});
+    v.Reserve(20u);
+    v.Insert(v.begin(), v.begin() + 2, v.end());
+    REQUIRE(v == Vector<int>{8, 2, 3, 1, 7, 8, 2, 3});
+    v.Insert(v.begin() + 2, 3u, v[0]);
+    REQUIRE(v == Vector<int>{8, 2, 8, 8, 8, 3, 1, 7, 8, 2, 3});
+    v.Insert(v.end(), {0, 0});
+    REQUIRE(v.Size() == 13u);
+    REQUIRE(v.Capacity() == 20u);
+    v.Insert(v.begin(), 10u, v.Back());
+    REQUIRE(v.Size() == 23u);
+    REQUIRE(v[9] == 0);
+    REQUIRE(v[10] == 8);
+  }
+
+  {
+    Vector<std::string> v{"a", "b", "c"};
+    v.Insert(v.begin() + 1, v.begin(), v.end());
+    REQUIRE(v == Vector<std::string>{"a", "a", "b", "c", "b", "c"});
+    v.Reserve(100u);
+    const auto data = v.Data();
+    v.Insert(v.begin() + 2, v.begin() + 4, v.end());
+    REQUIRE(v == Vector<std::string>{"a", "a", "b", "c", "b", "c", "b", "c"});
+    v.Insert(v.begin() + 1, 2u, std::string("x"));
+    REQUIRE(v == Vector<std::string>{"a", "x", "x", "a", "b", "c", "b", "c", "b", "c"});
+    std::istringstream input("y z");
+    REQUIRE(*v.Insert(v.begin() + 3, std::istream_iterator<std::string>(input), std::istream_iterator<std::string>()) == "y");
+    REQUIRE(v == Vector<std::string>{"a", "x", "x", "y", "z", "a", "b", "c", "b", "c", "b", "c"});
+    REQUIRE(v.Data() == data);
+  }
+
+  {
+    Vector<SelfPointer> v(5u);
+    const std::vector<SelfPointer> other(7u);
+    v.Insert(v.begin() + 2, other.begin(), other.end());
+    v.Insert(v.begin() + 1, 3u, SelfPointer(4));
+    REQUIRE(v.Size() == 15u);
+    REQUIRE(v[2].value == 4);
+    for (size_t i = 0; i < v.Size(); ++i) {
+      REQUIRE(v[i].self == &v[i]);
+    }
+  }
+
+  {
+    Throwable::until_throw = 100;
+    Vector<Throwable> v(4u);
+    const auto data = v.Data();
+    const std::vector<Throwable> other(3u);
+    Throwable::until_throw = 2;
+    REQUIRE_THROWS_AS(v.Insert(v.begin() + 1, other.begin(), other.end()), Exception);  // NOLINT
+    REQUIRE(v.Size() == 4u);
+    REQUIRE(v.Capacity() == 4u);
+    REQUIRE(v.Data() == data);
+  }
+}
+
+TEST_CASE("Assign", "[Bulk]") {
+  Vector<std::string> v{"a", "b", "c"};
+  const auto data = v.Data();
+  v.Assign({"x", "y"});
+  REQUIRE(v == Vector<std::string>{"x", "y"});
+  REQUIRE(v.Data() == data);
+  v.Assign(3u, v[1]);
+  REQUIRE(v == Vector<std::string>{"y", "y", "y"});
+  REQUIRE(v.Data() == data);
+  const std::vector<std::string> other{"1", "2", "3", "4", "5"};
+  v.Assign(other.begin(), other.end());
+  REQUIRE(v == Vector<std::string>{"1", "2", "3", "4", "5"});
+  v.Assign(v.begin() + 2, v.end());
+  REQUIRE(v == Vector<std::string>{"3", "4", "5"});
+  std::istringstream input("p q r s t u");
+  v.Assign(std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+  REQUIRE(v == Vector<std::string>{"p", "q", "r", "s", "t", "u"});
+  v.Assign(0u, "");
+  REQUIRE(v.Empty());
+}
+
+TEST_CASE("Uninitialized", "[ReallocationStrategy]") {
+  {
+    Vector<char> v;
+    const std::string_view chunk = "0123456789";
+    for (int i = 0; i < 100; ++i) {
+      char* destination = v.AppendUninitialized(64u);
+      REQUIRE(v.Capacity() - v.Size() >= 64u);
+      std::memcpy(destination, chunk.data(), chunk.size());
+      v.CommitAppend(chunk.size());
+    }
+    REQUIRE(v.Size() == 1000u);
+    REQUIRE(v.Capacity() <= 2048u);
+    for (size_t i = 0; i < v.Size(); ++i) {
+      REQUIRE(v[i] == chunk[i % 10]);
+    }
+    const auto data = v.Data();
+    REQUIRE_THROWS_AS(v.CommitAppend(v.Capacity() - v.Size() + 1), std::out_of_range);  // NOLINT
+    REQUIRE(v.AppendUninitialized(v.Capacity() - v.Size()) == data + 1000);
+    REQUIRE(v.Data() == data);
+  }
+
+  {
+    Vector<uint8_t> v(4u, 7);
+    v.ResizeUninitialized(1u << 16);
+    REQUIRE(v.Size() == (1u << 16));
+    REQUIRE(v[3] == 7u);
+    std::memset(v.Data() + 4, 1, v.Size() - 4);
+    v.ResizeUninitialized(2u);
+    REQUIRE(v == Vector<uint8_t>{7, 7});
+  }
+
+  {
+    Vector<std::string> v{"a"};
+    v.ResizeUninitialized(3u);
+    REQUIRE(v == Vector<std::string>{"a", "", ""});
+  }
+}
+
+struct alignas(64) CacheLine {
+  char bytes[64] = {};
+};
+
+template <class T>
+bool IsAligned(const T* pointer, size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+
+TEST_CASE("Alignment", "[Allocator]") {
+  {
+    AlignedVector<float> v;
+    v.PushBack(1.0f);
+    REQUIRE(v.Capacity() == 16u);
+    REQUIRE(IsAligned(v.Data(), 64u));
+    bool aligned = true;
+    bool padded = true;
+    for (int i = 1; i < (1 << 19); ++i) {
+      v.PushBack(static_cast<float>(i));
+      aligned = aligned && IsAligned(v.Data(), 64u);
+      padded = padded && v.Capacity() % 16u == 0u;
+    }
+    REQUIRE(aligned);
+    REQUIRE(padded);
+    REQUIRE(v[12345] == 12345.0f);
+    v.Resize(100u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 112u);
+    REQUIRE(IsAligned(v.Data(), 64u));
+    const AlignedVector<float> copy(v);
+    REQUIRE(IsAligned(copy.Data(), 64u));
+    REQUIRE(copy == v);
+  }
+
+  {
+    Vector<int, AlignedAllocator<int, 256>> v(3u, 5);
+    REQUIRE(v.Capacity() == 3u);
+    REQUIRE(IsAligned(v.Data(), 256u));
+    v.Reserve(50'000u);
+    REQUIRE(IsAligned(v.Data(), 256u));
+    v.Reserve(500'000u);
+    REQUIRE(IsAligned(v.Data(), 256u));
+    REQUIRE(v == Vector<int, AlignedAllocator<int, 256>>(3u, 5));
+  }
+
+  {
+    Vector<CacheLine> v;
+    for (int i = 0; i < 20'000; ++i) {
+      v.PushBack({});
+      REQUIRE(IsAligned(v.Data(), 64u));
+    }
+  }
+}
+
+enum class Color : uint16_t { kRed, kGreen };
+
+template <class T>
+void CheckComparison(const std::vector<T>& left, const std::vector<T>& right) {
+  const Vector<T> left_vector(left.begin(), left.end());
+  const Vector<T> right_vector(right.begin(), right.end());
+  const int8_t expected = left < right ? -1 : right < left ? 1 : 0;
+  REQUIRE(Compare(left_vector, right_vector) == expected);
+  REQUIRE((left_vector == right_vector) == (left == right));
+  REQUIRE((left_vector < right_vector) == (left < right));
+  const SmallVector<T, 16> left_small(left.begin(), left.end());
+  const SmallVector<T, 16> right_small(right.begin(), right.end());
+  REQUIRE(Compare(left_small, right_small) == expected);
+  REQUIRE((left_small == right_small) == (left == right));
+  REQUIRE((left_small < right_small) == (left < right));
+}
+
+TEST_CASE("Vectorized Comparisons", "[Vector]") {
+  std::vector<uint8_t> bytes(1000u, 200u);
+  std::vector<int> ints(1000u, -5);
+  std::vector<int64_t> longs(1000u, 1);
+  for (size_t position : {0u, 1u, 63u, 64u, 255u, 256u, 257u, 999u}) {
+    auto other_bytes = bytes;
+    other_bytes[position] = 3u;
+    CheckComparison(bytes, other_bytes);
+    CheckComparison(other_bytes, bytes);
+    auto other_ints = ints;
+    other_ints[position] = 7;
+    CheckComparison(ints, other_ints);
+    CheckComparison(other_ints, ints);
+    auto other_longs = longs;
+    other_longs[position] = -1;
+    CheckComparison(longs, other_longs);
+    CheckComparison(other_longs, longs);
+  }
+  CheckComparison(bytes, std::vector<uint8_t>(bytes.begin(), bytes.end() - 1));
+  CheckComparison(ints, ints);
+  CheckComparison(std::vector<int>{}, std::vector<int>{});
+  CheckComparison(std::vector<char>{'a', -1}, std::vector<char>{'a', 1});
+  CheckComparison(std::vector<int8_t>{-3, 2}, std::vector<int8_t>{3, 2});
+  CheckComparison(std::vector<Color>{Color::kRed}, std::vector<Color>{Color::kGreen});
+  CheckComparison(std::vector<double>{0.0, 1.0}, std::vector<double>{-0.0, 1.0});
+  CheckComparison(std::vector<bool>{true, false}, std::vector<bool>{true, true});
+}
+
+TEST_CASE("MappedVector", "[MappedVector]") {
+  const std::string path = "mapped_vector_test.bin";
+  std::remove(path.c_str());
+
+  {
+    MappedVector<uint64_t> v(path);
+    REQUIRE(v.Empty());
+    REQUIRE(v.IsWritable());
+    for (uint64_t i = 0; i < 100'000u; ++i) {
+      v.PushBack(i * i);
+    }
+    v.PushBack(v[10]);
+    const uint64_t more[] = {1, 2, 3};
+    v.Append(std::begin(more), std::end(more));
+    REQUIRE(v.Size() == 100'004u);
+    REQUIRE(v.Back() == 3u);
+    v.Sync();
+  }
+
+  {
+    const MappedVector<uint64_t> v(path, MappedVectorMode::kReadOnly);
+    REQUIRE(v.Size() == 100'004u);
+    REQUIRE(v[99'999] == uint64_t{99'999} * 99'999u);
+    REQUIRE(v[100'000] == 100u);
+    REQUIRE_THROWS_AS(v.At(100'004), std::out_of_range);  // NOLINT
+  }
+
+  {
+    MappedVector<uint64_t> v(path, MappedVectorMode::kReadOnly);
+    REQUIRE_THROWS_AS(v.PushBack(1), std::logic_error);  // NOLINT
+    REQUIRE_THROWS_AS(v[0], std::logic_error);          // NOLINT
+    REQUIRE_THROWS_AS(v.Data(), std::logic_error);      // NOLINT
+    REQUIRE_THROWS_AS(v.begin(), std::logic_error);     // NOLINT
+    REQUIRE_THROWS_AS(v.rend(), std::logic_error);      // NOLINT
+    REQUIRE(std::as_const(v)[10] == 100u);
+    REQUIRE(v.Size() == 100'004u);
+  }
+
+  REQUIRE_THROWS_AS(MappedVector<uint32_t>(path), MappedVectorFormatError);  // NOLINT
+
+  {
+    MappedVector<uint64_t> v(path);
+    v.Resize(10u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 10u);
+    v.Resize(20u);
+    REQUIRE(v[9] == 81u);
+    REQUIRE(v[15] == 0u);
+    auto moved = std::move(v);
+    moved.Resize(30u, 7u);
+    REQUIRE(moved.Back() == 7u);
+    v = std::move(moved);
+    v.PopBack();
+    REQUIRE(v.Size() == 29u);
+  }
+
+  REQUIRE(MappedVector<uint64_t>(path, MappedVectorMode::kReadOnly).Size() == 29u);
+
+  {
+    MappedVector<uint64_t> v(path);
+    v.Resize(1000u);
+    v.Resize(v.Capacity());
+    for (size_t i = 0; i < v.Size(); ++i) {
+      v[i] = i;
+    }
+    // Occupy the page after the mapping so that growing it has to move it.
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto mapping_end = reinterpret_cast<uintptr_t>(v.Data() + v.Capacity());
+    void* blocker = mmap(reinterpret_cast<void*>((mapping_end + page - 1) / page * page), page, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    const uint64_t* old_data = v.Data();
+    const size_t size = v.Size();
+    v.Append(v.begin(), v.end());
+    if (blocker != MAP_FAILED) {
+      REQUIRE(v.Data() != old_data);
+      munmap(blocker, page);
+    }
+    REQUIRE(v.Size() == 2 * size);
+    bool doubled = true;
+    for (size_t i = 0; i < size; ++i) {
+      doubled = doubled && v[i] == i && v[size + i] == i;
+    }
+    REQUIRE(doubled);
+  }
+
+  std::remove(path.c_str());
+  REQUIRE_THROWS_AS(MappedVector<uint64_t>(path, MappedVectorMode::kReadOnly), std::system_error);  // NOLINT
+}
+
+TEST_CASE("ConcurrentVector", "[ConcurrentVector]") {
+  {
+    ConcurrentVector<std::pair<int, int>> v;
+    const auto& first = v.EmplaceBack(-1, -1);
+    constexpr int kThreads = 8;
+    constexpr int kCount = 50'000;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> observed{0};
+    std::thread reader([&] {
+      while (!done.load()) {
+        const size_t size = v.Size();
+        for (size_t i = 0; i < size; i += 97) {
+          if (v.IsPublished(i) && v.At(i).first == v.At(i).second) {
+            observed.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+      writers.emplace_back([&v, t] {
+        for (int i = 0; i < kCount; ++i) {
+          v.PushBack({t * kCount + i, t * kCount + i});
+        }
+      });
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+    done.store(true);
+    reader.join();
+    REQUIRE(&first == &v[0]);
+    REQUIRE(first.first == -1);
+    REQUIRE(v.Size() == kThreads * kCount + 1u);
+    std::vector<bool> seen(kThreads * kCount);
+    bool all_published = true;
+    for (size_t i = 1; i < v.Size(); ++i) {
+      all_published = all_published && v.IsPublished(i);
+      seen[v[i].first] = true;
+    }
+    REQUIRE(all_published);
+    REQUIRE(std::find(seen.begin(), seen.end(), false) == seen.end());
+  }
+
+  {
+    ConcurrentVector<std::string> v;
+    v.Reserve(100u);
+    v.PushBack("a");
+    REQUIRE_THROWS_AS(v.EmplaceBack(std::string(), 1u, 0u), std::out_of_range);  // NOLINT
+    v.PushBack("c");
+    REQUIRE(v.Size() == 3u);
+    REQUIRE_FALSE(v.IsPublished(1));
+    REQUIRE_THROWS_AS(v.At(1), std::out_of_range);  // NOLINT
+    REQUIRE(v.At(2) == "c");
+    REQUIRE_FALSE(v.IsPublished(3));
+    v.Clear();
+    REQUIRE(v.Empty());
+    for (int i = 0; i < 1000; ++i) {
+      v.PushBack(std::to_string(i));
+    }
+    REQUIRE(v[999] == "999");
+  }
+}
+
+struct CopyBudget {
+  static std::atomic<int64_t> live;
+  static std::atomic<int64_t> copies_left;
+  int64_t value = 0;
+
+  CopyBudget() {
+    ++live;
+  }
+
+  explicit CopyBudget(int64_t value_param) : value(value_param) {
+    ++live;
+  }
+
+  CopyBudget(const CopyBudget& other) : value(other.value) {
+    if (--copies_left < 0) {
+      throw std::runtime_error("CopyBudget");
+    }
+    ++live;
+  }
+
+  CopyBudget& operator=(const CopyBudget&) = default;
+
+  ~CopyBudget() {
+    --live;
+  }
+};
+
+std::atomic<int64_t> CopyBudget::live{0};
+std::atomic<int64_t> CopyBudget::copies_left{0};
+
+// Its counters are atomic, so bulk operations may run on several threads.
+template <>
+struct IsParallelConstructible<CopyBudget> : std::true_type {};
+
+// Counts the objects constructed or destroyed away from the thread that created the first one.
+struct CallerOnly {
+  static std::thread::id caller;
+  static std::atomic<int> foreign;
+  int64_t value = 0;
+
+  CallerOnly() {
+    Check();
+  }
+
+  CallerOnly(const CallerOnly& other) : value(other.value) {
+    Check();
+  }
+
+  ~CallerOnly() {
+    Check();
+  }
+
+  static void Check() {
+    if (std::this_thread::get_id() != caller) {
+      ++foreign;
+    }
+  }
+};
+
+std::thread::id CallerOnly::caller;
+std::atomic<int> CallerOnly::foreign{0};
+
+TEST_CASE("Parallel Bulk Operations", "[Memory]") {
+  constexpr size_t kSize = 3 * kVectorParallelThreshold / sizeof(double) + 11;
+  {
+    Vector<double> v(kSize, 1.5);
+    REQUIRE(std::count(v.begin(), v.end(), 1.5) == static_cast<ptrdiff_t>(kSize));
+    v[kSize - 1] = 2.0;
+    Vector<double> copy(v);
+    REQUIRE(copy == v);
+    v.Assign(kSize + 1, 0.5);
+    REQUIRE(std::count(v.begin(), v.end(), 0.5) == static_cast<ptrdiff_t>(kSize + 1));
+  }
+
+  {
+    CopyBudget::copies_left = std::numeric_limits<int64_t>::max();
+    Vector<CopyBudget> v(kSize);
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(kSize));
+    for (size_t i = 0; i < kSize; i++) {
+      v[i].value = static_cast<int64_t>(i);
+    }
+    Vector<CopyBudget> copy(v);
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(2 * kSize));
+    REQUIRE(copy[kSize - 1].value == static_cast<int64_t>(kSize - 1));
+    copy.Clear();
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(kSize));
+
+    CopyBudget::copies_left = static_cast<int64_t>(kSize / 2);
+    REQUIRE_THROWS_AS(Vector<CopyBudget>(v), std::runtime_error);  // NOLINT
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(kSize));
+    CopyBudget::copies_left = static_cast<int64_t>(kSize - 1);
+    REQUIRE_THROWS_AS(Vector<CopyBudget>(kSize, CopyBudget(7)), std::runtime_error);  // NOLINT
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(kSize));
+    CopyBudget::copies_left = 0;
+    REQUIRE_THROWS_AS(copy = v, std::runtime_error);  // NOLINT
+    REQUIRE(copy.Empty());
+    REQUIRE(CopyBudget::live == static_cast<int64_t>(kSize));
+  }
+  REQUIRE(CopyBudget::live == 0);
+
+  static_assert(IsParallelConstructible<double>::value);
+  static_assert(IsParallelConstructible<std::string>::value);
+  static_assert(IsParallelConstructible<Vector<std::string>>::value);
+  static_assert(IsParallelConstructible<SmallVector<AlignedVector<float>, 2>>::value);
+  static_assert(!IsParallelConstructible<Vector<int, ResourceAllocator<int>>>::value);
+  static_assert(!IsParallelConstructible<std::basic_string<char, std::char_traits<char>, ResourceAllocator<char>>>::value);
+  static_assert(!IsParallelConstructible<Vector<CallerOnly>>::value);
+  {
+    constexpr size_t kStrings = 3 * kVectorParallelThreshold / sizeof(std::string) + 11;
+    Vector<std::string> strings(kStrings, std::string(40, 'x'));
+    strings[kStrings - 1] = "last";
+    Vector<std::string> copy(strings);
+    REQUIRE(copy == strings);
+    strings.Clear();
+    REQUIRE(copy[kStrings - 1] == "last");
+    const Vector<Vector<int>> nested(kVectorParallelThreshold / sizeof(Vector<int>) + 1, Vector<int>{1, 2, 3});
+    REQUIRE(Vector<Vector<int>>(nested).Back() == Vector<int>{1, 2, 3});
+  }
+  {
+    CallerOnly::caller = std::this_thread::get_id();
+    Vector<CallerOnly> v(kSize);
+    Vector<CallerOnly> copy(v);
+    Vector<CallerOnly> filled(kSize, CallerOnly());
+  }
+  REQUIRE(CallerOnly::foreign == 0);
+}
+
+TEST_CASE("SoaVector", "[SoaVector]") {
+  {
+    SoaVector<float, double, int, std::string> v;
+    REQUIRE(v.Empty());
+    REQUIRE(v.Data<0>() == nullptr);
+    for (int i = 0; i < 1000; ++i) {
+      v.PushBack(static_cast<float>(i), i * 0.5, -i, std::to_string(i));
+    }
+    REQUIRE(v.Size() == 1000u);
+    REQUIRE(v.Capacity() >= 1000u);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.Data<0>()) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.Data<1>()) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.Data<2>()) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.Data<3>()) % 64 == 0);
+    REQUIRE(v.Data<1>() - reinterpret_cast<const double*>(v.Data<0>()) <= static_cast<ptrdiff_t>(v.Capacity()));
+
+    auto [x, y, z, name] = v[10];
+    REQUIRE(x == 10.0f);
+    REQUIRE(y == 5.0);
+    REQUIRE(z == -10);
+    REQUIRE(name == "10");
+    x = 1.5f;
+    name += "!";
+    REQUIRE(v.Column<0>()[10] == 1.5f);
+    REQUIRE(std::get<3>(v.At(10)) == "10!");
+    v[11] = std::make_tuple(0.0f, 0.0, 0, std::string("zero"));
+    REQUIRE(v.Column<3>()[11] == "zero");
+    REQUIRE_THROWS_AS(v.At(1000), std::out_of_range);  // NOLINT
+
+    double sum = 0;
+    for (double value : v.Column<1>()) {
+      sum += value;
+    }
+    REQUIRE(sum == 0.5 * 999 * 1000 / 2 - 5.5);
+    int count = 0;
+    for (auto [a, b, c, d] : v) {
+      count += c <= 0;
+    }
+    REQUIRE(count == 1000);
+
+    v.EmplaceBack(1, 2, 3, v.Column<3>()[0]);
+    REQUIRE(std::get<3>(v[1000]) == "0");
+    v.PopBack();
+    v.Resize(5);
+    REQUIRE(v.Size() == 5u);
+    v.ShrinkToFit();
+    REQUIRE(v.Capacity() == 5u);
+    REQUIRE(v.Column<3>()[4] == "4");
+    v.Resize(7);
+    REQUIRE(v.Column<3>()[6].empty());
+
+    SoaVector<float, double, int, std::string> copy(v);
+    REQUIRE(copy.Size() == 7u);
+    REQUIRE(copy.Column<3>()[4] == "4");
+    SoaVector<float, double, int, std::string> moved(std::move(copy));
+    REQUIRE(copy.Empty());  // NOLINT
+    REQUIRE(moved.Column<2>()[3] == -3);
+    copy = moved;
+    moved.Clear();
+    REQUIRE(moved.Empty());
+    REQUIRE(std::get<3>(copy[2]) == "2");
+    const auto& constant = copy;
+    REQUIRE(std::get<0>(constant[3]) == 3.0f);
+    REQUIRE(constant.Column<1>().Size() == 7u);
+  }
+
+  {
+    CopyBudget::copies_left = std::numeric_limits<int64_t>::max();
+    using Rows = SoaVector<std::string, CopyBudget>;
+    Rows v(100);
+    REQUIRE(CopyBudget::live == 100);
+    CopyBudget::copies_left = 50;
+    REQUIRE_THROWS_AS(Rows(v), std::runtime_error);  // NOLINT
+    REQUIRE(CopyBudget::live == 100);
+    CopyBudget::copies_left = std::numeric_limits<int64_t>::max();
+    v.PushBack("x", CopyBudget(1));
+    REQUIRE(CopyBudget::live == 101);
+    CopyBudget::copies_left = 0;
+    const CopyBudget budget(2);
+    REQUIRE_THROWS_AS(v.PushBack("y", budget), std::runtime_error);  // NOLINT
+    REQUIRE(v.Size() == 101u);
+    REQUIRE(CopyBudget::live == 102);
+  }
+  REQUIRE(CopyBudget::live == 0);
+}
+
+TEST_CASE("SharedVector", "[SharedVector]") {
+  {
+    SharedVector<int> empty;
+    REQUIRE(empty.Empty());
+    REQUIRE(empty.UseCount() == 0u);
+    REQUIRE_THROWS_AS(empty.At(0), std::out_of_range);  // NOLINT
+    empty.Mutable().PushBack(1);
+    REQUIRE(empty.Size() == 1u);
+
+    SharedVector<int> a(Vector<int>{1, 2, 3});
+    SharedVector<int> b = a;
+    REQUIRE(a.UseCount() == 2u);
+    REQUIRE(a.Data() == b.Data());
+    b.Mutable().PushBack(4);
+    REQUIRE(a.UseCount() == 1u);
+    REQUIRE(a.Get() == Vector<int>{1, 2, 3});
+    REQUIRE(b.Get() == Vector<int>{1, 2, 3, 4});
+    const int* data = b.Data();
+    b.Mutable()[0] = 10;
+    REQUIRE(b.Data() == data);
+    REQUIRE(std::accumulate(b.begin(), b.end(), 0) == 19);
+    a = b;
+    REQUIRE(a.At(0) == 10);
+    REQUIRE(b.UseCount() == 2u);
+    SharedVector<int> c = std::move(a);
+    REQUIRE(b.UseCount() == 2u);
+    REQUIRE(c[3] == 4);
+  }
+
+  {
+    AtomicSharedVector<int> slot(SharedVector<int>(Vector<int>{1}));
+    SharedVector<int> first = slot.Load();
+    REQUIRE(first.Get() == Vector<int>{1});
+    REQUIRE(first.UseCount() == 2u);
+    SharedVector<int> second(Vector<int>{2, 2});
+    slot.Store(second);
+    REQUIRE(first.UseCount() == 1u);
+    REQUIRE(slot.Load().Data() == second.Data());
+    SharedVector<int> old = slot.Exchange(first);
+    REQUIRE(old.Data() == second.Data());
+    REQUIRE(slot.Load().Data() != first.Data());
+    REQUIRE(slot.Load().Get() == Vector<int>{1});
+  }
+
+  {
+    AtomicSharedVector<int> slot(SharedVector<int>(Vector<int>(1u, 1)));
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+      readers.emplace_back([&] {
+        int last = 1;
+        while (!done.load()) {
+          SharedVector<int> table = slot.Load();
+          const int size = static_cast<int>(table.Size());
+          if (size < last || std::count(table.begin(), table.end(), size) != size) {
+            torn++;
+          }
+          last = size;
+        }
+      });
+    }
+    for (int version = 2; version <= 2000; ++version) {
+      SharedVector<int> next = slot.Load();
+      next.Mutable().Assign(static_cast<size_t>(version), version);
+      slot.Store(std::move(next));
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    REQUIRE(torn == 0);
+    REQUIRE(slot.Load().Size() == 2000u);
+    REQUIRE(slot.Load().UseCount() == 2u);
+  }
+}